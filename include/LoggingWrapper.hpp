@@ -28,6 +28,15 @@
 
 namespace logging {
 void setVerboseMode(bool mode);
+// Redirects the console output of the calling thread into the given stream,
+// nullptr restores std::cout/std::cerr. The logfile is not affected.
+// Returns the stream captured before.
+std::ostream* captureConsoleOutput(std::ostream* stream);
+// Redirects the console output of all threads into the given stream,
+// nullptr restores std::cout/std::cerr. The logfile is not affected.
+void redirectConsoleOutput(std::ostream* stream);
+// The stream the console output of the calling thread is written to.
+std::ostream& consoleOutput();
 }
 
 namespace libLogging {
@@ -13,51 +13,75 @@
  **/
 
 #include "LoggingWrapper.hpp"
+
+#include <atomic>
+#include <utility>
 namespace logging {
 static bool verboseMode = false;
+static thread_local std::ostream *consoleCapture = nullptr;
+static std::atomic<std::ostream *> consoleRedirect = nullptr;
 void setVerboseMode(bool mode) { verboseMode = mode; }
+std::ostream *captureConsoleOutput(std::ostream *stream) {
+  return std::exchange(consoleCapture, stream);
+}
+void redirectConsoleOutput(std::ostream *stream) { consoleRedirect = stream; }
+static std::ostream &out() {
+  if (consoleCapture != nullptr) {
+    return *consoleCapture;
+  }
+  std::ostream *redirect = consoleRedirect;
+  return redirect != nullptr ? *redirect : std::cout;
+}
+static std::ostream &err() {
+  if (consoleCapture != nullptr) {
+    return *consoleCapture;
+  }
+  std::ostream *redirect = consoleRedirect;
+  return redirect != nullptr ? *redirect : std::cerr;
+}
+std::ostream &consoleOutput() { return out(); }
 } // namespace logging
 
 namespace libLogging {
 LoggingWrapper::~LoggingWrapper() {
   switch (this->level) {
   case LogLevel::OUTP:
-    std::cout << this->buffer.str();
+    logging::out() << this->buffer.str();
     LOG(INFO) << this->prefix << this->buffer.str();
     break;
   case LogLevel::INFO:
     if (logging::verboseMode) {
-      std::cout << libLogging::GRAY_FG << this->prefix << this->buffer.str()
-                << libLogging::RESET << std::endl;
+      logging::out() << libLogging::GRAY_FG << this->prefix << this->buffer.str()
+                     << libLogging::RESET << std::endl;
     }
     LOG(INFO) << this->prefix << this->buffer.str();
     break;
   case LogLevel::WARNING:
-    std::cout << libLogging::YELLOW_FG << this->buffer.str()
-              << libLogging::RESET << "\n"
-              << std::endl;
+    logging::out() << libLogging::YELLOW_FG << this->buffer.str()
+                   << libLogging::RESET << "\n"
+                   << std::endl;
     LOG(WARNING) << this->prefix << this->buffer.str();
     break;
   case LogLevel::ERROR:
-    std::cerr << libLogging::ERROR << this->prefix << this->buffer.str()
-              << libLogging::RESET << "\n"
-              << std::endl;
+    logging::err() << libLogging::ERROR << this->prefix << this->buffer.str()
+                   << libLogging::RESET << "\n"
+                   << std::endl;
     LOG(ERROR) << this->prefix << this->buffer.str();
     break;
   case LogLevel::FATAL:
-    std::cerr << libLogging::BLACK_FG << libLogging::RED_BG << this->prefix
-              << this->buffer.str() << libLogging::RESET << std::endl;
+    logging::err() << libLogging::BLACK_FG << libLogging::RED_BG << this->prefix
+                   << this->buffer.str() << libLogging::RESET << std::endl;
     LOG(FATAL) << this->prefix << this->buffer.str();
     break;
   case LogLevel::DEBUG:
-    std::cout << libLogging::ITALIC << libLogging::CYAN_FG << this->prefix
-              << this->buffer.str() << libLogging::RESET << std::endl;
+    logging::out() << libLogging::ITALIC << libLogging::CYAN_FG << this->prefix
+                   << this->buffer.str() << libLogging::RESET << std::endl;
     LOG(DEBUG) << this->prefix << this->buffer.str();
     break;
   }
 }
 LoggingWrapper &LoggingWrapper::operator<<(Manipulator manipulator) {
-  manipulator(std::cout);
+  manipulator(logging::out());
   this->buffer << manipulator;
   return *this;
 }
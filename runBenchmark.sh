@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Generates a corpus of JSON files on a tmpfs and measures the runtime with
+# and without io_uring. Afterwards snapshots of the corpus are converted to
+# compare loading snapshots with parsing the JSON files.
+# Usage: ./runBenchmark.sh [number of files] [entries per file]
+#
+# Other builds can be compared by listing their executables, e.g. a build
+# with the pool allocator:
+# BENCHMARK_EXECUTABLES="build-pool/json2batch build/json2batch" ./runBenchmark.sh
+
+# Number of files to be generated
+FILE_COUNT="${1:-100000}"
+# Number of entries within each file
+ENTRY_COUNT="${2:-3}"
+
+# Define the paths to the executables
+EXECUTABLES="${BENCHMARK_EXECUTABLES:-build/json2batch}"
+
+# Directory for the corpus, /dev/shm is a tmpfs on most systems
+CORPUS_DIR="/dev/shm/json2batch-benchmark"
+
+# Check if the executables exist, relative paths have to work from within
+# the corpus
+RESOLVED_EXECUTABLES=()
+for executable in $EXECUTABLES; do
+    if [ ! -x "$executable" ]; then
+        echo "Error: Executable '$executable' not found or not executable."
+        exit 1
+    fi
+    RESOLVED_EXECUTABLES+=("$(realpath "$executable")")
+done
+
+rm -rf "$CORPUS_DIR"
+mkdir -p "$CORPUS_DIR/in" "$CORPUS_DIR/out"
+echo "Generating $FILE_COUNT files with $ENTRY_COUNT entries in $CORPUS_DIR..."
+
+# awk writes the files a lot faster than a loop within bash
+awk -v count="$FILE_COUNT" -v entries="$ENTRY_COUNT" -v dir="$CORPUS_DIR/in" 'BEGIN {
+    for (i = 0; i < count; i++) {
+        file = dir "/" i ".json"
+        printf "{\n    \"outputfile\": \"%d.bat\",\n    \"hideshell\": true,\n", i > file
+        print "    \"entries\": [" > file
+        for (j = 0; j < entries; j++) {
+            separator = j < entries - 1 ? "," : ""
+            if (j % 3 == 0) {
+                printf "        {\"type\": \"EXE\", \"command\": \"C:\\\\tools\\\\MinGW\\\\set_distro_paths_%d.bat\"}%s\n", j, separator > file
+            } else if (j % 3 == 1) {
+                printf "        {\"type\": \"ENV\", \"key\": \"BOOST_INCLUDEDIR_%d\", \"value\": \"C:\\\\tools\\\\MinGW\\\\include\"}%s\n", j, separator > file
+            } else {
+                printf "        {\"type\": \"PATH\", \"path\": \"C:\\\\tools\\\\MinGW\\\\bin_%d\"}%s\n", j, separator > file
+            }
+        }
+        print "    ],\n    \"application\": \"C:\\\\tools\\\\VSCode\\\\Code.exe\"\n}" > file
+        close(file)
+    }
+}'
+
+for executable in "${RESOLVED_EXECUTABLES[@]}"; do
+    # Short relative paths keep the arguments below ARG_MAX
+    pushd "$CORPUS_DIR/in" > /dev/null || exit
+
+    for option in "--no-io-uring" ""; do
+        # The output directory is recreated, so no file has to be overwritten
+        rm -rf "$CORPUS_DIR/out" && mkdir "$CORPUS_DIR/out"
+        echo "----------------------------------------"
+        echo "Running $executable with options: ${option:-(default)}"
+        time "$executable" $option -o "$CORPUS_DIR/out" *.json > /dev/null
+    done
+
+    # The snapshots are written next to the batch files
+    rm -rf "$CORPUS_DIR/out" "$CORPUS_DIR/snap" && mkdir "$CORPUS_DIR/out" "$CORPUS_DIR/snap"
+    "$executable" --emit-snapshot -o "$CORPUS_DIR/snap" *.json > /dev/null
+    rm -f "$CORPUS_DIR"/snap/*.bat
+    pushd "$CORPUS_DIR/snap" > /dev/null || exit
+    echo "----------------------------------------"
+    echo "Running $executable with snapshots as input"
+    time "$executable" -o "$CORPUS_DIR/out" *.j2b > /dev/null
+
+    popd > /dev/null && popd > /dev/null || exit
+done
+
+rm -rf "$CORPUS_DIR"
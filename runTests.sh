@@ -32,3 +32,29 @@ done
 cd -
 
 "$EXECUTABLE" $files -o "samples/results"
+
+# A copy of a configuration, whose batch file has been overwritten by
+# another configuration, has to be converted instead of copied
+DUPLICATES_DIR="samples/tests/duplicates"
+DUPLICATES_RESULTS="samples/results/duplicates"
+rm -rf "$DUPLICATES_RESULTS" && mkdir -p "$DUPLICATES_RESULTS"
+yes y | "$EXECUTABLE" "$DUPLICATES_DIR" -o "$DUPLICATES_RESULTS" > /dev/null
+
+if ! grep -q 'C:\\one' "$DUPLICATES_RESULTS/b/x.bat"; then
+    echo "Error: '$DUPLICATES_RESULTS/b/x.bat' was copied from an overwritten file."
+    exit 1
+fi
+
+# Variables, whose keys aren't valid shell names, are skipped within the
+# shell script instead of breaking it
+SHELL_KEYS_DIR="samples/tests/shellKeys"
+SHELL_KEYS_RESULTS="samples/results/shellKeys"
+rm -rf "$SHELL_KEYS_RESULTS" && mkdir -p "$SHELL_KEYS_RESULTS"
+yes y | "$EXECUTABLE" "$SHELL_KEYS_DIR" --format bat,sh -o "$SHELL_KEYS_RESULTS" > /dev/null
+
+if ! sh -n "$SHELL_KEYS_RESULTS/shellKeys.sh" ||
+        ! grep -q "^export VALID_KEY1='valid'$" "$SHELL_KEYS_RESULTS/shellKeys.sh" ||
+        grep -q "hyphen\|parentheses\|digit" "$SHELL_KEYS_RESULTS/shellKeys.sh"; then
+    echo "Error: '$SHELL_KEYS_RESULTS/shellKeys.sh' exports invalid keys."
+    exit 1
+fi
@@ -0,0 +1,157 @@
+/**
+ * @file Arena.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-13
+ * @version 0.3.0
+ * @brief Contains the Arena and ArenaPool classes.
+ *
+ * @see utilities::Arena
+ * @see utilities::ArenaPool
+ *
+ * @see src/sources/Arena.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace utilities {
+/**
+ * @class Arena
+ * @brief Monotonic memory for everything created while converting one file
+ * @details
+ * The FileData, its strings and the content of the batch file are allocated
+ * from the arena of the file. Nothing is freed individually, instead the
+ * whole arena is reset after the batch file has been written and is then
+ * reused for the next file.
+ *
+ * The arena starts with a buffer of INITIAL_SIZE bytes. If a file needs more
+ * than that, the buffer is enlarged on the next reset, so that following
+ * files of similar size don't need the heap at all.
+ *
+ * @note An arena may only be used by one thread at a time.
+ */
+class Arena {
+public:
+    /**
+     * @brief Size of the buffer of a new arena in bytes
+     */
+    static constexpr std::size_t INITIAL_SIZE = 16 * 1024;
+
+    /**
+     * @brief Maximum size the buffer is enlarged to in bytes
+     */
+    static constexpr std::size_t MAX_SIZE = 1024 * 1024;
+
+    /**
+     * @struct Statistics
+     * @brief Allocation counts of all arenas, reported by --stats
+     */
+    struct Statistics {
+        std::uint64_t arenas = 0; /** < Number of arenas created */
+        std::uint64_t resets = 0; /** < Number of files using an arena */
+        std::uint64_t allocations = 0; /** < Allocations from arenas */
+        std::uint64_t bytes = 0; /** < Bytes allocated from arenas */
+        std::uint64_t heapAllocations = 0; /** < Buffer was too small */
+        std::uint64_t heapBytes = 0; /** < Bytes taken from the heap */
+    };
+
+    /**
+     * @brief Creates an arena with a buffer of INITIAL_SIZE bytes
+     */
+    Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @brief Getter for the memory resource of the arena
+     * @return The resource to be used by pmr containers
+     */
+    [[nodiscard]] std::pmr::memory_resource *getResource() {
+        return &this->counter;
+    }
+
+    /**
+     * @brief Frees everything allocated from the arena at once
+     * @details
+     * Adds the counts of the arena to the statistics. Nothing allocated from
+     * the arena may be used afterwards.
+     */
+    void reset();
+
+    /**
+     * @brief Getter for the statistics of all arenas
+     * @return The summed up counts of all arenas which have been reset
+     */
+    [[nodiscard]] static Statistics getStatistics();
+
+private:
+    /**
+     * @class CountingResource
+     * @brief Counts the allocations passed on to another resource
+     */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource *upstream)
+            : upstream(upstream) {}
+
+        std::pmr::memory_resource *upstream;
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+
+    private:
+        void *do_allocate(std::size_t size, std::size_t alignment) override;
+        void do_deallocate(void *pointer, std::size_t size,
+                           std::size_t alignment) override;
+        [[nodiscard]] bool
+        do_is_equal(const std::pmr::memory_resource &other) const noexcept
+        override {
+            return this == &other;
+        }
+    };
+
+    std::size_t bufferSize = INITIAL_SIZE;
+    std::unique_ptr<std::byte[]> buffer;
+    CountingResource heap{std::pmr::new_delete_resource()};
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+    CountingResource counter{nullptr};
+};
+
+/**
+ * @class ArenaPool
+ * @brief Keeps arenas which are currently unused
+ * @details
+ * Within the ConversionPipeline the file is converted on one thread and
+ * written on another, so the arena is passed along with the file and given
+ * back to the pool once the file has been written.
+ */
+class ArenaPool {
+public:
+    /**
+     * @brief Takes an unused arena or creates a new one
+     * @return The arena
+     */
+    std::unique_ptr<Arena> acquire();
+
+    /**
+     * @brief Resets the arena and keeps it for the next file
+     * @param arena The arena, nothing allocated from it may still be alive
+     */
+    void release(std::unique_ptr<Arena> arena);
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Arena>> arenas;
+};
+} // namespace utilities
+
+#endif // ARENA_HPP
@@ -0,0 +1,118 @@
+/**
+ * @file BaseCache.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-23
+ * @version 0.3.0
+ * @brief Contains the BaseCache class.
+ *
+ * @see parsing::BaseCache
+ *
+ * @see src/sources/BaseCache.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef BASECACHE_HPP
+#define BASECACHE_HPP
+
+#include "FileData.hpp"
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parsing {
+/**
+ * @class BaseCache
+ * @brief The base configurations named by "extends", parsed once per run
+ * @details
+ * Each base file is read, parsed and validated the first time it is
+ * extended. The resulting FileData is immutable and shared by all
+ * configurations and threads extending it. Errors are cached as well, so a
+ * broken base is only parsed once and reported for every configuration.
+ *
+ * Bases may extend other bases. The bases are loaded one at a time, so a
+ * base extending itself (directly or through other bases) is detected
+ * without any thread waiting for another one.
+ *
+ * This class is singleton, like KeyValidator.
+ */
+class BaseCache {
+public:
+    /**
+     * @brief Get the instance of this class
+     *
+     * @return Reference to the instance of this class
+     */
+    static BaseCache &getInstance();
+
+    /**
+     * @brief Returns a base configuration, loading it if needed
+     *
+     * @param path The path of the base, see resolve()
+     *
+     * @return The parsed base, shared with all other users
+     *
+     * @throw exceptions::FailedToOpenFileException
+     * @throw exceptions::InvalidValueException If the base extends itself
+     * @throw Any exception of JsonHandler, if the base is invalid
+     */
+    [[nodiscard]] std::shared_ptr<const FileData> get(const std::string &path);
+
+    /**
+     * @brief Resolves the path of a base
+     * @details
+     * Relative paths are relative to the directory of the extending file.
+     * The path is normalized, so every base is only cached once.
+     *
+     * @param extending The name of the extending file or configuration
+     * @param base The path given by "extends"
+     *
+     * @return The path of the base
+     */
+    [[nodiscard]] static std::string resolve(std::string_view extending,
+            std::string_view base);
+
+    /**
+     * @brief Number of bases loaded so far
+     */
+    [[nodiscard]] std::size_t size();
+
+private:
+    /**
+     * @struct Entry
+     * @brief A loaded base
+     */
+    struct Entry {
+        std::shared_ptr<const FileData> data; /** < Null if it failed */
+        std::exception_ptr error; /** < Set if loading failed */
+    };
+
+    BaseCache() = default;
+
+    /**
+     * @brief Looks up a base, which has already been loaded
+     *
+     * @return Null if the base hasn't been loaded yet
+     */
+    [[nodiscard]] const Entry *find(const std::string &path);
+
+    /**
+     * @brief Returns the data of an entry or throws its error
+     */
+    [[nodiscard]] static std::shared_ptr<const FileData> take(
+        const Entry &entry);
+
+    std::mutex mutex; /** < Guards entries */
+    std::unordered_map<std::string, Entry> entries;
+    // Held while loading, bases extending bases are loaded recursively
+    std::recursive_mutex loadingMutex;
+    // The bases currently being loaded, guarded by loadingMutex
+    std::vector<std::string> loading;
+};
+} // namespace parsing
+
+#endif // BASECACHE_HPP
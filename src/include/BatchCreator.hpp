@@ -12,55 +12,153 @@
  * @copyright See LICENSE file
  *
  */
+#ifndef BATCHCREATOR_HPP
+#define BATCHCREATOR_HPP
 
 #include "FileData.hpp"
+#include "ScriptCreator.hpp"
+#include <cstddef>
 #include <memory>
-#include <sstream>
+#include <string_view>
 
 /**
  * @class BatchCreator
  * @brief Creates a batch file from a FileData obeject
  * @details
- * Uses a FileData object to create a string stream, which can then
- * be streamed into a batch file.
+ * Uses a FileData object to create a string, which can then
+ * be written into a batch file.
+ * Since 0.3.0 the string is allocated with the allocator of the FileData
+ * object, instead of a separately allocated stringstream.
+ * - Derives from ScriptCreator since 0.3.0, like the creators of the other
+ *   formats
+ *
+ * The whole configuration is written into a single cmd.exe line. As cmd.exe
+ * can't run lines longer than MAX_LINE_LENGTH, large configurations are
+ * written with one statement per line instead (see Layout).
  *
  * @see FileData
  */
-class BatchCreator {
+class BatchCreator : public ScriptCreator<BatchCreator> {
 public:
+    /**
+     * @enum Layout
+     * @brief How the batch file is laid out
+     */
+    enum class Layout {
+        AUTO, /** < SINGLE_LINE, unless the line would be too long */
+        SINGLE_LINE, /** < Everything within one cmd.exe call */
+        MULTI_LINE /** < setlocal and one statement per line */
+    };
+
+    /**
+     * @brief Maximum length of a line cmd.exe can run
+     */
+    static constexpr std::size_t MAX_LINE_LENGTH = 8191;
+
+    /**
+     * @brief Length kept free for expanding %path% when the line is run
+     */
+    static constexpr std::size_t EXPANSION_RESERVE = 2048;
+
+    /**
+     * @brief Maximum length of the entries set within one line of PATH
+     */
+    static constexpr std::size_t PATH_CHUNK_SIZE = 4096;
+
     /**
      * @brief Initializes the BatchCreator
      * @details
-     * Creates a stringstream and calls the createBatch() function
+     * Creates the string and calls the createBatch() function
      *
      * @param filenData A shared pointer to the FileData object
+     * @param layout The layout of the batch file
      *
      */
-    explicit BatchCreator(std::shared_ptr<parsing::FileData> fileData);
+    explicit BatchCreator(std::shared_ptr<parsing::FileData> fileData,
+                          Layout layout = Layout::AUTO);
+
+private:
+    // Writes the parts of the single line
+    friend class ScriptCreator<BatchCreator>;
+
+    /**
+     * @brief Size of the text around the value(s) of an entry
+     */
+    static constexpr std::size_t ENTRY_SIZE = 8;
 
     /**
-     * @brief Returns the stringstream
+     * @brief Size of the text around an entry within the multi-line layout
+     */
+    static constexpr std::size_t MULTI_LINE_ENTRY_SIZE = 24;
+
+    Layout layout; /** < Layout of the batch file */
+
+    /**
+     * @brief Creates the batch content
+     * @details
+     * The method calls all necessary functions to create the content of the
+     * batch file.
      *
-     * @return A shared pointer to the stringstream
      */
-    [[nodiscard]] std::shared_ptr<std::stringstream> getDataStream() const {
-        return dataStream;
-    }
+    void createBatch();
 
-private:
-    std::shared_ptr<std::stringstream>
-    dataStream; /** < stringstream for the batch file */
+    /**
+     * @brief Checks if the single cmd.exe line would be too long
+     * @details
+     * Stops counting as soon as the limit is reached, so huge configurations
+     * aren't counted twice.
+     *
+     * @return True if the line and EXPANSION_RESERVE exceed MAX_LINE_LENGTH
+     */
+    [[nodiscard]] bool exceedsLineLimit() const;
+
+    /**
+     * @brief Creates the batch content with one statement per line
+     * @details
+     * - The environment is kept local to the batch file using setlocal
+     * - Commands are run using call, so batch files return to the script.
+     *   If a command fails, the remaining statements are skipped, like
+     *   with "&&" in the single line
+     * - PATH is extended by one line per PATH_CHUNK_SIZE, using delayed
+     *   expansion, as %path% would soon exceed the line limit itself
+     * - If the shell should stay open, cmd.exe /k is started at the end
+     *
+     */
+    void createMultiLineBatch();
 
-    std::shared_ptr<parsing::FileData> fileData; /** < FileData object */
+    /**
+     * @brief Writes the commands, one per line
+     */
+    void writeMultiLineCommands();
 
     /**
-     * @brief Creates the batch stream
+     * @brief Writes the environment variables, one per line
+     */
+    void writeMultiLineEnvVariables();
+
+    /**
+     * @brief Writes the path variables in chunks of PATH_CHUNK_SIZE
      * @details
-     * The method calls all necessary functions to create the stream for the batch
-     * file.
+     * Every chunk is put in front of PATH, so the chunks are written from
+     * the last one to the first one.
      *
      */
-    void createBatch() const;
+    void writeMultiLinePathVariables();
+
+    /**
+     * @brief Appends a value, which is read with delayed expansion
+     * @details
+     * Escapes "^", which would be removed by the delayed expansion. "!"
+     * isn't allowed within values at all.
+     *
+     * @param value The value to be appended
+     */
+    void appendDelayedExpansion(std::string_view value);
+
+    /**
+     * @brief Writes the start of the application and the end of the file
+     */
+    void writeMultiLineEnd();
 
     /**
      * @brief Wirtes the start of the batch file
@@ -68,9 +166,10 @@ private:
      * Writes the start of the batch file, which is always the same:
      * - setzt ECHO off
      * - startet cmd.exe
+     * - calls writeHideShell()
      *
      */
-    void writeStart() const;
+    void writeStart();
 
     /**
      * @brief Writes the visibility of the shell
@@ -79,7 +178,7 @@ private:
      * - {ReqFunc19}
      *
      */
-    void writeHideShell() const;
+    void writeHideShell();
 
     /**
      * @brief Writes the commands to be executed
@@ -90,7 +189,7 @@ private:
      * - {ReqFunc22}
      *
      */
-    void writeCommands() const;
+    void writeCommands();
 
     /**
      * @brief Set's environment variables
@@ -103,7 +202,7 @@ private:
      * - {ReqFunc21}
      *
      */
-    void writeEnvVariables() const;
+    void writeEnvVariables();
 
     /**
      * @brief Set's the path variables
@@ -113,7 +212,7 @@ private:
      * - {ReqFunc23}
      *
      */
-    void writePathVariables() const;
+    void writePathVariables();
 
     /**
      * @brief If an application is given, it is started at the end
@@ -124,7 +223,7 @@ private:
      * - {ReqFunc25}
      *
      */
-    void writeApplication() const;
+    void writeApplication();
 
     /**
      * @brief Writes the end of the batch file
@@ -133,5 +232,7 @@ private:
      * - @ECHO ON
      *
      */
-    void writeEnd() const;
+    void writeEnd();
 };
+
+#endif // BATCHCREATOR_HPP
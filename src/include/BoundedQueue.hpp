@@ -0,0 +1,144 @@
+/**
+ * @file BoundedQueue.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-10
+ * @version 0.3.0
+ * @brief Contains the BoundedQueue class template.
+ *
+ * @see utilities::BoundedQueue
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace utilities {
+/**
+ * @class BoundedQueue
+ * @brief A thread safe queue with a maximum size
+ * @details
+ * The queue connects the stages of the ConversionPipeline. If the queue is
+ * full, push() blocks until an element has been taken out. That way a fast
+ * stage can only work ahead by the capacity of the queue.
+ *
+ * After close() was called, push() fails and pop() returns the remaining
+ * elements followed by std::nullopt.
+ *
+ * @tparam T The type of the elements
+ */
+template <typename T> class BoundedQueue {
+public:
+    /**
+     * @brief Creates an empty queue
+     * @param capacity The maximum number of elements within the queue
+     */
+    explicit BoundedQueue(std::size_t capacity) : capacity(capacity) {}
+
+    /**
+     * @brief Adds an element, waits while the queue is full
+     *
+     * @param value The element to be added
+     *
+     * @return False if the queue has been closed
+     */
+    bool push(T value) {
+        std::unique_lock lock(this->mutex);
+        this->notFull.wait(lock, [this] {
+            return this->closed || this->items.size() < this->capacity;
+        });
+
+        if (this->closed) {
+            return false;
+        }
+
+        this->items.push_back(std::move(value));
+        this->notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Adds an element without waiting
+     *
+     * @param value The element to be added, only moved if it was added
+     *
+     * @return False if the queue is full or has been closed
+     */
+    bool tryPush(T &value) {
+        std::unique_lock lock(this->mutex);
+
+        if (this->closed || this->items.size() >= this->capacity) {
+            return false;
+        }
+
+        this->items.push_back(std::move(value));
+        this->notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Takes the first element, waits while the queue is empty
+     *
+     * @return The element or std::nullopt if the queue is closed and empty
+     */
+    std::optional<T> pop() {
+        std::unique_lock lock(this->mutex);
+        this->notEmpty.wait(lock, [this] {
+            return this->closed || !this->items.empty();
+        });
+        return this->take();
+    }
+
+    /**
+     * @brief Takes the first element without waiting
+     *
+     * @return The element or std::nullopt if the queue is empty
+     */
+    std::optional<T> tryPop() {
+        std::unique_lock lock(this->mutex);
+        return this->take();
+    }
+
+    /**
+     * @brief Closes the queue
+     * @details
+     * Wakes up all waiting threads. Elements which are already within the
+     * queue can still be taken out.
+     */
+    void close() {
+        std::unique_lock lock(this->mutex);
+        this->closed = true;
+        this->notFull.notify_all();
+        this->notEmpty.notify_all();
+    }
+
+private:
+    /**
+     * @brief Takes the first element, the mutex has to be locked
+     */
+    std::optional<T> take() {
+        if (this->items.empty()) {
+            return std::nullopt;
+        }
+
+        std::optional<T> value(std::move(this->items.front()));
+        this->items.pop_front();
+        this->notFull.notify_one();
+        return value;
+    }
+
+    const std::size_t capacity;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    bool closed = false;
+};
+} // namespace utilities
+
+#endif // BOUNDEDQUEUE_HPP
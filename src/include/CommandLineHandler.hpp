@@ -22,6 +22,8 @@
 #define COMMANDLINEHANDLER_HPP
 
 
+#include "BatchCreator.hpp"
+#include "ScriptCreator.hpp"
 #include <getopt.h>
 #include <string>
 #include <vector>
@@ -41,6 +43,34 @@
  */
 namespace cli {
 
+/**
+ * @struct Arguments
+ * @brief The options and files parsed from the command line
+ * @details
+ * Introduced in 0.3.0, as the number of options grew too large for a tuple.
+ *
+ * @see CommandLineHandler::parseArguments()
+ */
+struct Arguments {
+    std::optional<std::string> outDir; /** < Output directory, if given */
+    std::vector<std::string> files; /** < Files given as arguments */
+    std::vector<std::string> fileLists; /** < --files-from and "@" lists */
+    bool ioUring = true; /** < Use io_uring for file I/O, if available */
+    bool stats = false; /** < Print statistics after converting */
+    bool emitSnapshot = false; /** < Write a snapshot for every file */
+    unsigned jobs = 1; /** < Threads converting files, 0 for all cores */
+    bool toStdout = false; /** < Write the batch files to stdout */
+    std::optional<std::string> archive; /** < Archive to write to, if given */
+    std::vector<std::string> includes; /** < Files searched in directories */
+    std::vector<std::string> excludes; /** < Skipped within directories */
+    std::optional<std::string> ignoreFile; /** < E.g. ".gitignore" */
+    BatchCreator::Layout layout = BatchCreator::Layout::AUTO; /** < --layout */
+    bool optimize = false; /** < Remove duplicate entries */
+    std::vector<ScriptFormat> formats{ScriptFormat::BAT}; /** < --format */
+    std::vector<std::string> defines; /** < -D NAME=VALUE */
+    std::vector<std::string> definesFiles; /** < --defines */
+};
+
 /**
  * @class CommandLineHandler
  * @brief Responsible for the Command Line Interface.
@@ -90,10 +120,9 @@ public:
      * @param argc The number of arguments given
      * @param argv The arguments given
      *
-     * @return Returns a tuple containing the output directory and the files
+     * @return Returns the parsed options and the files
      */
-    static std::tuple<std::optional<std::string>, std::vector<std::string>>
-    parseArguments(int argc, char* argv[]);
+    static Arguments parseArguments(int argc, char* argv[]);
     /**
      * @brief The Constructor of the CommandLineHandler Class
      * @note As all functions are static it should not be used and as such
@@ -124,6 +153,21 @@ static const struct option options[] = {
     {"credits", no_argument, nullptr, 'c'}, /** < Credits */
     {"verbose", no_argument, nullptr, 0}, /** < Verbose */
     {"outdir", required_argument, nullptr, 'o'}, /** < Output directory */
+    {"jobs", required_argument, nullptr, 'j'}, /** < Number of jobs */
+    {"no-io-uring", no_argument, nullptr, 0}, /** < Disable io_uring */
+    {"stats", no_argument, nullptr, 0}, /** < Print statistics */
+    {"emit-snapshot", no_argument, nullptr, 0}, /** < Write snapshots */
+    {"stdout", no_argument, nullptr, 0}, /** < Write to stdout */
+    {"archive", required_argument, nullptr, 0}, /** < Write an archive */
+    {"include", required_argument, nullptr, 0}, /** < Include pattern */
+    {"exclude", required_argument, nullptr, 0}, /** < Exclude pattern */
+    {"ignore-file", required_argument, nullptr, 0}, /** < Ignore files */
+    {"files-from", required_argument, nullptr, 0}, /** < List of files */
+    {"layout", required_argument, nullptr, 0}, /** < Layout of batch files */
+    {"optimize", no_argument, nullptr, 0}, /** < Remove duplicate entries */
+    {"format", required_argument, nullptr, 0}, /** < Formats to be written */
+    {"define", required_argument, nullptr, 'D'}, /** < Define a value */
+    {"defines", required_argument, nullptr, 0}, /** < File with defines */
     nullptr
 };
 
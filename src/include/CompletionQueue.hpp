@@ -0,0 +1,182 @@
+/**
+ * @file CompletionQueue.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-27
+ * @version 0.3.0
+ * @brief Contains the CompletionQueue class template.
+ *
+ * @see utilities::CompletionQueue
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef COMPLETIONQUEUE_HPP
+#define COMPLETIONQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace utilities {
+/**
+ * @class CompletionQueue
+ * @brief A thread safe queue of results, which may complete in any order
+ * @details
+ * A producer reserves a slot for each result, before its work is started,
+ * and completes the slot once the result is known. The consumer takes the
+ * results:
+ * - In completion order, so a slow result doesn't hold back the ones
+ *   completed after it
+ * - Or, if the queue is ordered, in the order of the reservations
+ *
+ * Like BoundedQueue the number of slots is bounded: reserve() blocks until
+ * a result has been taken out, so the producer can only work ahead by the
+ * capacity of the queue.
+ *
+ * The consumer passes a predicate, which may hold back a completed result,
+ * e.g. until another one it depends on has been taken. It is called with
+ * the number of the other reserved slots, i.e. the results still to come,
+ * and has to accept a result eventually.
+ *
+ * After close() was called, reserve() fails and pop() returns the remaining
+ * results followed by std::nullopt.
+ *
+ * @tparam T The type of the results
+ */
+template <typename T> class CompletionQueue {
+public:
+    /**
+     * @brief Creates an empty queue
+     *
+     * @param capacity The maximum number of reserved slots
+     * @param ordered Take the results in the order of their reservations
+     */
+    CompletionQueue(std::size_t capacity, bool ordered)
+        : slots(capacity), ordered(ordered) {
+        for (std::size_t slot = capacity; slot > 0; --slot) {
+            this->free.push_back(slot - 1);
+        }
+    }
+
+    /**
+     * @brief Reserves a slot for a result, waits while all slots are taken
+     *
+     * @return The slot or std::nullopt if the queue has been closed
+     */
+    std::optional<std::size_t> reserve() {
+        std::unique_lock lock(this->mutex);
+        this->notFull.wait(lock, [this] {
+            return this->closed || !this->free.empty();
+        });
+
+        if (this->closed) {
+            return std::nullopt;
+        }
+
+        const std::size_t slot = this->free.back();
+        this->free.pop_back();
+        this->reserved.push_back(slot);
+        return slot;
+    }
+
+    /**
+     * @brief Completes a reserved slot
+     *
+     * @param slot The slot returned by reserve()
+     * @param value The result
+     */
+    void complete(std::size_t slot, T value) {
+        std::unique_lock lock(this->mutex);
+        this->slots[slot] = std::move(value);
+        this->ready.push_back(slot);
+        this->notEmpty.notify_one();
+    }
+
+    /**
+     * @brief Takes a result, waits until one is completed and accepted
+     *
+     * @param accept Called as accept(result, others) for completed results
+     *
+     * @return The result or std::nullopt if the queue is closed and no slot
+     * is reserved anymore
+     */
+    template <typename Predicate> std::optional<T> pop(Predicate accept) {
+        std::unique_lock lock(this->mutex);
+        std::optional<T> value;
+        this->notEmpty.wait(lock, [this, &accept, &value] {
+            value = this->take(accept);
+            return value || (this->closed && this->reserved.empty());
+        });
+        return value;
+    }
+
+    /**
+     * @brief Takes a result without waiting
+     *
+     * @param accept Called as accept(result, others) for completed results
+     *
+     * @return The result or std::nullopt if no result is completed and
+     * accepted
+     */
+    template <typename Predicate> std::optional<T> tryPop(Predicate accept) {
+        std::unique_lock lock(this->mutex);
+        return this->take(accept);
+    }
+
+    /**
+     * @brief Closes the queue
+     * @details
+     * Wakes up all waiting threads. Slots which are already reserved can
+     * still be completed and taken out.
+     */
+    void close() {
+        std::unique_lock lock(this->mutex);
+        this->closed = true;
+        this->notFull.notify_all();
+        this->notEmpty.notify_all();
+    }
+
+private:
+    /**
+     * @brief Takes the first accepted result, the mutex has to be locked
+     */
+    template <typename Predicate> std::optional<T> take(Predicate &accept) {
+        const std::size_t others = this->reserved.size() - 1;
+
+        for (auto slot = this->ready.begin(); slot != this->ready.end(); ++slot) {
+            // Ordered, only the oldest reservation may be taken
+            if (this->ordered && *slot != this->reserved.front()) {
+                continue;
+            }
+
+            if (!accept(*this->slots[*slot], others)) {
+                continue;
+            }
+
+            std::optional<T> value(std::move(this->slots[*slot]));
+            this->slots[*slot].reset();
+            std::erase(this->reserved, *slot);
+            this->free.push_back(*slot);
+            this->ready.erase(slot);
+            this->notFull.notify_one();
+            return value;
+        }
+
+        return std::nullopt;
+    }
+
+    std::vector<std::optional<T>> slots; /** < The results by their slot */
+    const bool ordered;
+    std::vector<std::size_t> free; /** < Slots, which aren't reserved */
+    std::deque<std::size_t> reserved; /** < In the order of reservation */
+    std::deque<std::size_t> ready; /** < Completed slots, oldest first */
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    bool closed = false;
+};
+} // namespace utilities
+
+#endif // COMPLETIONQUEUE_HPP
@@ -0,0 +1,719 @@
+/**
+ * @file ConversionPipeline.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-10
+ * @version 0.3.0
+ * @brief Contains the ConversionPipeline class.
+ *
+ * @see parsing::ConversionPipeline
+ *
+ * @see src/sources/ConversionPipeline.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef CONVERSIONPIPELINE_HPP
+#define CONVERSIONPIPELINE_HPP
+
+#include "Arena.hpp"
+#include "BatchCreator.hpp"
+#include "ScriptCreator.hpp"
+#include "BoundedQueue.hpp"
+#include "CompletionQueue.hpp"
+#include "FileList.hpp"
+#include "FileSystemCache.hpp"
+#include "InputFile.hpp"
+#include "FileData.hpp"
+#include "IoUring.hpp"
+#include "JsonHandler.hpp"
+#include "LargestFirstQueue.hpp"
+#include "TarWriter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace parsing {
+/**
+ * @class ConversionPipeline
+ * @brief Converts all files using overlapping stages
+ * @details
+ * Each file has to be read, parsed, converted and written. Instead of doing
+ * this one file after the other, each step runs as it's own stage:
+ * - The reader stage reads ahead up to PREFETCH_DEPTH files
+ * - The conversion stage splits files with multiple configurations (see
+ *   JsonSplitter), parses them and creates the batch content
+ * - The writer stage asks before overwriting and writes the batch files
+ *
+ * The stages are connected by BoundedQueue instances, so the memory used
+ * is bounded by the depth of the queues and not by the number of files.
+ * The reader and conversion stage run on their own threads, the writer
+ * stage runs on the thread calling run(), as it is the only stage which
+ * interacts with the user.
+ *
+ * With more than one job, the configurations are converted by a pool of
+ * worker threads. The conversion stage then only splits the files and
+ * reserves a slot of a utilities::CompletionQueue for each configuration,
+ * which the worker completes. The writer stage writes the batch files in
+ * the order they are completed, so a huge file doesn't hold back the ones
+ * after it. Only the standard output and the archive are written in the
+ * order of the configurations. The workers take the configurations from a
+ * utilities::LargestFirstQueue, so the largest configuration waiting is
+ * converted first, see getWorkerStatistics().
+ *
+ * Errors and the console output of the other stages are passed along with
+ * the file and are handled by the writer stage along with its batch file.
+ *
+ * Everything created while converting a file is allocated from an arena,
+ * which is passed along with the file and reset once it has been written.
+ *
+ * Snapshots (see Snapshot) are loaded instead of parsed and, if requested,
+ * written next to the batch files.
+ *
+ * The file STANDARD_INPUT is read as a stream, each configuration is passed
+ * on as soon as it is complete. Instead of files, the batch files can be
+ * written to the standard output, see writeStandardOutput(), or into a
+ * single archive, see utilities::TarWriter.
+ *
+ * When writing files, each configuration is only converted once: the
+ * conversion stage hashes the configurations and passes identical ones on
+ * as duplicates, which the writer stage copies from the batch file already
+ * written, see copyDuplicate(). Only the last MAX_ORIGINALS configurations
+ * are remembered, so the memory doesn't grow with the number of files.
+ *
+ * A configuration with profiles is parsed once, its profiles are then
+ * created by the other workers, see convertProfiles().
+ * - Replaces the loop within main() since 0.3.0
+ *
+ * @see utilities::BoundedQueue
+ * @see utilities::Arena
+ */
+class ConversionPipeline {
+public:
+    /**
+     * @brief Maximum number of files between two stages
+     */
+    static constexpr std::size_t PREFETCH_DEPTH = 64;
+
+    /**
+     * @brief Name of the file, which reads from the standard input
+     */
+    static constexpr std::string_view STANDARD_INPUT = "-";
+
+    /**
+     * @brief Size of the chunks the standard input is read in
+     */
+    static constexpr std::size_t STANDARD_INPUT_CHUNK = 64 * 1024;
+
+    /**
+     * @brief Maximum number of configurations, which are copied if repeated
+     */
+    static constexpr std::size_t MAX_ORIGINALS = 4096;
+
+    /**
+     * @brief Maximum size of all configurations, which are copied if repeated
+     * @details
+     * Their content is kept to compare them, a larger configuration is
+     * always converted.
+     */
+    static constexpr std::size_t MAX_ORIGINAL_BYTES = 16 * 1024 * 1024;
+
+    /**
+     * @struct Options
+     * @brief Options of the pipeline
+     * @details
+     * Introduced in 0.3.0, as the number of options grew too large for the
+     * constructor.
+     */
+    struct Options {
+        std::string outputDirectory; /** < The directory for the batch files */
+        bool useIoUring = false; /** < Use io_uring for the I/O if available */
+        bool emitSnapshot = false; /** < Write a snapshot for every file */
+        unsigned jobCount = 1; /** < Threads converting the configurations */
+        bool toStandardOutput = false; /** < Write to stdout, not to files */
+        std::string archive; /** < Archive to write to, empty for files */
+        BatchCreator::Layout layout = BatchCreator::Layout::AUTO; /** < Of the batch files */
+        bool optimize = false; /** < Remove duplicate entries, see Optimizer */
+        // Formats created from every configuration, the first one is the
+        // batch file, which is checked before overwriting it
+        std::vector<ScriptFormat> formats{ScriptFormat::BAT};
+    };
+
+    /**
+     * @struct WorkerStatistics
+     * @brief What a worker thread did during the run, reported by --stats
+     */
+    struct WorkerStatistics {
+        std::uint64_t configurations = 0; /** < Converted by the worker */
+        std::uint64_t chunks = 0; /** < Chunks of other configurations */
+        std::chrono::nanoseconds busy{0}; /** < Spent converting */
+        std::chrono::nanoseconds alive{0}; /** < From start to end */
+        std::chrono::nanoseconds longest{0}; /** < Longest configuration */
+        // End of the last configuration, the spread between the workers is
+        // the tail of the run
+        std::chrono::steady_clock::time_point finished;
+    };
+
+    /**
+     * @brief Initialises the pipeline
+     *
+     * @param files The files to be converted, which may still be growing
+     * until it is closed
+     * @param options The options of the pipeline
+     *
+     * @throw exceptions::FailedToOpenFileException If the archive can't be
+     * created
+     */
+    ConversionPipeline(const utilities::FileList &files, Options options);
+
+    /**
+     * @brief Converts all files
+     * @details
+     * Starts the reader and conversion stage and runs the writer stage until
+     * all files have been handled.
+     *
+     * @note Ends the application, if the user doesn't want to continue
+     * after an error.
+     *
+     * @throw exceptions::ArchiveException If the archive can't be finished
+     */
+    void run();
+
+    /**
+     * @brief Getter for the statistics of the worker threads
+     *
+     * @return One entry per worker of the last run, empty with a single job
+     */
+    [[nodiscard]] static std::vector<WorkerStatistics> getWorkerStatistics();
+
+private:
+    /**
+     * @struct Input
+     * @brief A file which has been read by the reader stage
+     */
+    struct Input {
+        std::size_t file; /** < Index of the file */
+        std::optional<utilities::InputFile> content; /** < The content */
+        std::exception_ptr error; /** < Set if reading failed */
+        std::string messages; /** < Console output while reading */
+        std::size_t line = 0; /** < Line of a configuration from stdin */
+        bool hasMore = false; /** < More configurations follow on stdin */
+    };
+
+    /**
+     * @brief How identical configurations can use the files of a converted one
+     */
+    enum class Reuse : unsigned char {
+        UNKNOWN, /** < Not parsed yet, the writer stage decides */
+        COPY, /** < Copied anywhere */
+        SAME_DIRECTORY, /** < Has bases, only copied within its directory */
+        CONVERT /** < Has profiles or failed, always converted */
+    };
+
+    /**
+     * @struct Job
+     * @brief A configuration to be converted
+     */
+    struct Job {
+        std::size_t file = 0; /** < Index of the file containing it */
+        std::string name{}; /** < The file or the configuration within it */
+        bool hasMore = false; /** < False for the last configuration of all files */
+        std::shared_ptr<const utilities::InputFile> input{}; /** < The file */
+        std::string_view content{}; /** < The configuration within the file */
+        std::exception_ptr error{}; /** < Set if reading or splitting failed */
+        std::string messages{}; /** < Console output while reading/splitting */
+        std::size_t sequence = 0; /** < Position among all configurations */
+        // Set by convert() for the first of identical configurations
+        std::shared_ptr<std::atomic<Reuse>> reuse{};
+    };
+
+    /**
+     * @struct ContentHash
+     * @brief 128 bit hash of a configuration, see hashContent()
+     */
+    struct ContentHash {
+        std::uint64_t first; /** < std::hash of the content */
+        std::uint64_t second; /** < FNV-1a of the content */
+
+        bool operator==(const ContentHash &) const = default;
+    };
+
+    /**
+     * @brief Hash function of ContentHash for unordered containers
+     */
+    struct ContentHashHasher {
+        std::size_t operator()(const ContentHash &hash) const {
+            return static_cast<std::size_t>(hash.first);
+        }
+    };
+
+    /**
+     * @struct Original
+     * @brief The first of identical configurations, see dispatch()
+     */
+    struct Original {
+        std::size_t sequence; /** < Position among all configurations */
+        std::string content; /** < Compared, as hashes may collide */
+        std::string directory; /** < Directory its bases are resolved from */
+        std::shared_ptr<std::atomic<Reuse>> reuse; /** < Set once parsed */
+    };
+
+    /**
+     * @struct WrittenFile
+     * @brief A batch file, which has been written, see copyDuplicate()
+     */
+    struct WrittenFile {
+        std::string fileName; /** < Full path of the batch file */
+        std::vector<std::string> companions; /** < Full paths of companions */
+        std::size_t directorySize; /** < Size of the output directory */
+        // Set if it has bases, which are resolved from this directory
+        std::optional<std::string> basesDirectory;
+    };
+
+    /**
+     * @struct Companion
+     * @brief A file written along with the batch file, without asking
+     * @details
+     * The scripts of further formats and the snapshot.
+     */
+    struct Companion {
+        std::string fileName; /** < Full path of the file */
+        std::pmr::string content; /** < Allocated from the arena */
+    };
+
+    /**
+     * @struct Output
+     * @brief A batch file created by the conversion stage
+     */
+    struct Output {
+        std::size_t file = 0; /** < Index of the parsed file */
+        std::string name{}; /** < The file or the configuration within it */
+        bool hasMore = false; /** < False for the last configuration of all files */
+        std::unique_ptr<utilities::Arena> arena{}; /** < Owns the content */
+        std::string fileName{}; /** < Full path of the batch file */
+        std::pmr::string content{}; /** < Content of the batch file */
+        std::vector<Companion> companions{}; /** < Written along with it */
+        std::exception_ptr error{}; /** < Set if reading or parsing failed */
+        std::string messages{}; /** < Console output while reading/parsing */
+        std::size_t sequence = 0; /** < Position among all configurations */
+        std::optional<Job> duplicate{}; /** < Set instead of the content */
+        std::size_t duplicateOf = 0; /** < Sequence of the identical one */
+        // Set instead of the content, one batch file per profile
+        std::vector<std::future<Output>> variants{};
+        bool copyable = false; /** < Identical ones may copy its files */
+        // Set if it has bases, which are resolved from this directory
+        std::optional<std::string> basesDirectory{};
+    };
+
+    /**
+     * @struct Pending
+     * @brief A configuration, which has been passed to the writer stage
+     */
+    struct Pending {
+        std::future<Output> output{}; /** < Fulfilled once converted */
+        std::size_t sequence = 0; /** < Position among all configurations */
+        bool hasMore = false; /** < False for the last configuration of all files */
+        // Set for a duplicate, the sequence of the identical one
+        std::optional<std::size_t> duplicateOf{};
+    };
+
+    /**
+     * @struct Task
+     * @brief Work for the workers, a configuration or a chunk of one
+     */
+    struct Task {
+        std::packaged_task<void()> run{}; /** < Converts a configuration */
+        bool chunk = false; /** < Or a chunk of one, see ParallelChunks */
+    };
+
+    /**
+     * @brief Reads all files, runs on it's own thread
+     */
+    void readStage();
+
+    /**
+     * @brief Reads the configurations from the standard input
+     * @details
+     * The input is read in chunks, each configuration is passed on as soon
+     * as its end has been read. A top level array is passed on as a whole.
+     * The first configuration is held back until the next one starts or the
+     * input ends, so it's known whether it's the only one.
+     *
+     * @param file Index of the file STANDARD_INPUT
+     *
+     * @return False if the pipeline has been stopped
+     */
+    bool readStandardInput(std::size_t file);
+
+    /**
+     * @brief Splits and converts the read files, runs on it's own thread
+     */
+    void convertStage();
+
+    /**
+     * @brief Converts the jobs of the conversion stage
+     * @details
+     * Runs on each worker thread, if there is more than one job.
+     *
+     * @param worker Index of the worker
+     */
+    void workerStage(std::size_t worker);
+
+    /**
+     * @brief Writes the converted files, runs on the calling thread
+     */
+    void writeStage();
+
+    /**
+     * @brief Decides whether the writer stage takes a converted file
+     * @details
+     * A duplicate waits for the identical configuration and the last
+     * configuration of all files waits for the others, so the user is only
+     * asked to continue if there is something left.
+     *
+     * @param pending The converted file
+     * @param others The number of files, which aren't taken yet
+     *
+     * @return True if the file can be written now
+     */
+    [[nodiscard]] bool isWritable(const Pending &pending,
+                                  std::size_t others) const;
+
+    /**
+     * @brief Marks a configuration as taken by the writer stage
+     *
+     * @param sequence The position of the configuration
+     */
+    void markHandled(std::size_t sequence);
+
+    /**
+     * @brief Splits a file into its configurations and dispatches them
+     *
+     * @param input The file to be split
+     *
+     * @return False if the pipeline has been stopped
+     */
+    bool split(Input &input);
+
+    /**
+     * @brief Passes a job on to be converted
+     * @details
+     * Without worker threads the job is converted right away.
+     *
+     * A job with the same content as a remembered one is passed on as a
+     * duplicate instead, unless the parsed original has profiles, failed or
+     * has bases within another directory. Otherwise it's remembered, see
+     * remember().
+     *
+     * @param job The job to be converted
+     *
+     * @return False if the pipeline has been stopped
+     */
+    bool dispatch(Job job);
+
+    /**
+     * @brief Hashes a configuration
+     * @details
+     * Two independent 64 bit hashes, so configurations are only taken as
+     * identical, if all 128 bits match.
+     *
+     * @param content The configuration
+     *
+     * @return The hash of the configuration
+     */
+    [[nodiscard]] static ContentHash hashContent(std::string_view content);
+
+    /**
+     * @brief Remembers the first of identical configurations
+     * @details
+     * The oldest ones are forgotten, once there are MAX_ORIGINALS of them
+     * or their content exceeds MAX_ORIGINAL_BYTES.
+     *
+     * @param hash The hash of the configuration
+     * @param job The configuration, which is told to set its Reuse
+     */
+    void remember(const ContentHash &hash, Job &job);
+
+    /**
+     * @brief Retrieves the directory of a file or configuration
+     *
+     * @param name The name of the file or configuration
+     *
+     * @return The directory including the last separator, may be empty
+     */
+    [[nodiscard]] static std::string_view directoryOf(std::string_view name);
+
+    /**
+     * @brief Parses a configuration and creates the batch content
+     *
+     * @param job The configuration to be converted
+     *
+     * @return The batch file, which still has to be written
+     */
+    [[nodiscard]] Output convert(Job &job);
+
+    /**
+     * @brief Creates the batch content of a parsed configuration
+     *
+     * @param output The batch file, owning the arena used
+     * @param fileData The parsed configuration
+     */
+    void createBatch(Output &output, const std::shared_ptr<FileData> &fileData);
+
+    /**
+     * @brief Creates the script of one format
+     *
+     * @param format The format, see Options::formats
+     * @param fileData The parsed configuration
+     *
+     * @return The script, allocated from the arena of the FileData object
+     */
+    [[nodiscard]] std::pmr::string createScript(ScriptFormat format,
+            const std::shared_ptr<FileData> &fileData) const;
+
+    /**
+     * @brief Creates a task for each profile of a configuration
+     * @details
+     * The shared part is parsed and validated once. The tasks are passed to
+     * the workers, as long as the queue of jobs isn't full, their futures
+     * are added to the variants of the output.
+     *
+     * @param output The configuration with profiles
+     * @param jsonHandler The parsed configuration
+     * @param size The size of the configuration, used for each profile
+     *
+     * @return The tasks, which have to be run by the caller
+     */
+    [[nodiscard]] std::vector<Task> convertProfiles(
+                Output &output, const std::shared_ptr<JsonHandler> &jsonHandler,
+                std::size_t size);
+
+    /**
+     * @brief Creates the batch content of a profile
+     *
+     * @param job The profile to be converted, without content
+     * @param jsonHandler The parsed configuration
+     * @param profile The name of the profile
+     * @param shared The shared part of the configuration
+     *
+     * @return The batch file, which still has to be written
+     */
+    [[nodiscard]] Output convertProfile(Job &job, const JsonHandler &jsonHandler,
+                                        const std::string &profile,
+                                        const FileData &shared);
+
+    /**
+     * @brief Handles and writes a batch of converted files
+     * @details
+     * Errors are handled and the user is asked before overwriting a file.
+     * With io_uring all files of the batch are checked and written at once.
+     *
+     * @param batch The converted files
+     */
+    void writeBatch(std::vector<Output> &batch);
+
+    /**
+     * @brief Clears a written batch and releases the arenas of its files
+     *
+     * @param batch The written files
+     */
+    void releaseBatch(std::vector<Output> &batch);
+
+    /**
+     * @brief Remembers a batch file, so identical ones can be copied
+     * @details
+     * Only the last MAX_ORIGINALS + 2 * PREFETCH_DEPTH files are remembered.
+     *
+     * @param output The batch file, which is going to be written
+     */
+    void rememberWritten(const Output &output);
+
+    /**
+     * @brief Forgets a batch file, so identical ones are converted instead
+     *
+     * @param sequence The sequence of the configuration of the file
+     */
+    void forgetWritten(std::size_t sequence);
+
+    /**
+     * @brief Forgets the batch files, whose files are overwritten
+     * @details
+     * Called for every file written, as it may replace the batch file or a
+     * companion of an earlier configuration, whose identical ones would be
+     * copied from the new content otherwise.
+     *
+     * @param output The batch file, which is going to be written
+     */
+    void forgetOverwritten(const Output &output);
+
+    /**
+     * @brief Writes a single file
+     *
+     * @param file The file to be written
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    static void writeOutput(const utilities::OutputFile &file);
+
+    /**
+     * @brief Adds a converted configuration to the batch to be written
+     * @details
+     * A configuration with profiles is replaced by its profiles, waiting
+     * for each of them.
+     *
+     * @param batch The batch to be written
+     * @param output The converted configuration
+     */
+    void addToBatch(std::vector<Output> &batch, Output output);
+
+    /**
+     * @brief Names the files of a duplicate after the identical file
+     * @details
+     * The batch file has the name of the identical one within the output
+     * directory of the duplicate. If the identical file hasn't been written
+     * (e.g. as it failed, has profiles or was forgotten), has bases within
+     * another directory or has the same name, the duplicate is converted
+     * after all.
+     *
+     * @param output The duplicate, which is replaced if converted
+     */
+    void resolveDuplicate(Output &output);
+
+    /**
+     * @brief Copies the files of a duplicate from the identical ones
+     * @details
+     * If writing the identical file failed, the duplicate is converted and
+     * written instead.
+     *
+     * @param output The duplicate to be written
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    void copyDuplicate(const Output &output);
+
+    /**
+     * @brief Copies a file
+     * @details
+     * On Linux the copy shares the blocks of the file (reflink), if the file
+     * system supports it, otherwise it is copied within the kernel.
+     *
+     * @param from The file to be copied
+     * @param to The copy, which is overwritten if it exists
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    static void copyFile(const std::string &from, const std::string &to);
+
+    /**
+     * @brief Writes a batch file to the standard output
+     * @details
+     * If the run consists of a single configuration creating a single batch
+     * file, it is written as is. Otherwise each is written as its path and
+     * its content, both terminated by a NUL character, which can't be part
+     * of a batch file. This is decided once, by the first batch file. The
+     * output is flushed after each configuration.
+     *
+     * @param output The batch file to be written
+     */
+    void writeStandardOutput(const Output &output);
+
+    /**
+     * @brief Appends a batch file and it's companions to the archive
+     * @details
+     * The files are named like the files, which would have been written.
+     *
+     * @param output The batch file to be written
+     */
+    void writeArchive(const Output &output);
+
+    /**
+     * @brief Returns the output directory of a file
+     *
+     * @param file Index of the file
+     *
+     * @return The output directory followed by the subdirectory of the file
+     */
+    [[nodiscard]] std::string outputDirectory(
+        std::size_t file) const;
+
+    /**
+     * @brief Creates the subdirectory of a file within the output directory
+     * @details
+     * Each directory is only created once.
+     *
+     * @param output The file to be written
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    void createSubdirectory(const Output &output);
+
+    /**
+     * @brief Runs a step for a file and handles its exceptions
+     * @details
+     * If the step throws one of our exceptions, the user is asked whether to
+     * continue with the other files. If not, the pipeline is stopped and the
+     * application ends.
+     *
+     * @param step The step to be run
+     * @param output The file the step is run for
+     *
+     * @return True if the step was successful, false if the file is skipped
+     */
+    bool runForFile(const std::function<void()> &step, const Output &output);
+
+    /**
+     * @brief Stops all stages and waits for their threads
+     */
+    void stop();
+
+    const utilities::FileList &files;
+    const Options options;
+    std::optional<utilities::IoUring> writeRing; /** < Used by the writer */
+    std::optional<utilities::TarWriter> archive; /** < Used by the writer */
+    std::unordered_set<std::string> archived; /** < Files in the archive */
+    std::unordered_set<std::string> createdDirectories; /** < By the writer */
+    utilities::FileSystemCache outputCache; /** < Used by the writer */
+    // The first configuration with a hash, used by the converter
+    std::unordered_map<ContentHash, Original, ContentHashHasher> contents;
+    std::deque<ContentHash> contentOrder; /** < Oldest one first */
+    std::size_t contentBytes = 0; /** < Size of all remembered contents */
+    std::size_t nextSequence = 0; /** < Used by the converter */
+    // Batch files by the sequence of their configuration, used by the writer
+    std::unordered_map<std::size_t, WrittenFile> writtenFiles;
+    std::deque<std::size_t> writtenOrder; /** < Oldest one first */
+    // The sequence of the remembered batch file each path belongs to
+    std::unordered_map<std::string, std::size_t> writtenPaths;
+    // Configurations taken by the writer, all below handledBelow and those
+    // taken ahead of them
+    std::size_t handledBelow = 0;
+    std::unordered_set<std::size_t> handled;
+    std::size_t duplicates = 0; /** < Copied batch files, used by the writer */
+    // Whether the standard output is framed, see writeStandardOutput()
+    std::optional<bool> framedStandardOutput;
+    utilities::ArenaPool arenas;
+    utilities::BoundedQueue<Input> inputs{PREFETCH_DEPTH};
+    // Largest configuration first, taken by the workers
+    utilities::LargestFirstQueue<Task> jobs{PREFETCH_DEPTH};
+    // Completed by the workers, the standard output and the archive are
+    // written in the order of the configurations
+    utilities::CompletionQueue<Pending> outputs{
+        PREFETCH_DEPTH, this->options.toStandardOutput || !this->options.archive.empty()};
+    std::thread reader;
+    std::thread converter;
+    std::vector<std::thread> workers;
+};
+} // namespace parsing
+
+#endif // CONVERSIONPIPELINE_HPP
@@ -0,0 +1,188 @@
+/**
+ * @file DirectoryWalker.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-19
+ * @version 0.3.0
+ * @brief Contains the DirectoryWalker class.
+ *
+ * @see utilities::DirectoryWalker
+ *
+ * @see src/sources/DirectoryWalker.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef DIRECTORYWALKER_HPP
+#define DIRECTORYWALKER_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utilities {
+/**
+ * @struct WalkedFile
+ * @brief A file found by the DirectoryWalker
+ */
+struct WalkedFile {
+    std::string path; /** < Path of the file, starting with the directory */
+    std::string subdirectory; /** < Directory relative to the searched one */
+};
+
+/**
+ * @class DirectoryWalker
+ * @brief Searches directories recursively for configurations
+ * @details
+ * The directories are read on multiple threads, each thread takes the next
+ * directory that has been found. The type of an entry is taken from the
+ * directory listing itself, so only symbolic links have to be checked
+ * separately. Symbolic links to directories are not followed.
+ *
+ * Which files are returned is decided by glob patterns (see matchGlob()).
+ * Patterns containing a '/' are matched against the path relative to the
+ * searched directory, other patterns against the name of the file:
+ * - A file has to match one of the include patterns
+ * - Files and directories matching an exclude pattern are skipped
+ * - Ignore files within the directories exclude files like .gitignore does
+ *   for the directory they are in, including "!" and a trailing "/"
+ *
+ * The files are returned sorted by their path, independent of the threads.
+ */
+class DirectoryWalker {
+public:
+    /**
+     * @brief Include patterns, if none are given
+     */
+    static constexpr std::string_view DEFAULT_INCLUDES[] = {
+        "*.json", "*.jsonl", "*.j2b"
+    };
+
+    /**
+     * @brief Minimum number of threads reading directories
+     * @details
+     * Reading directories mostly waits for the file system, so more threads
+     * than cores are used.
+     */
+    static constexpr unsigned MIN_THREADS = 4;
+
+    /**
+     * @struct Options
+     * @brief Options of the search
+     */
+    struct Options {
+        std::vector<std::string> includes; /** < Default: DEFAULT_INCLUDES */
+        std::vector<std::string> excludes; /** < Patterns to be skipped */
+        std::optional<std::string> ignoreFile; /** < E.g. ".gitignore" */
+    };
+
+    /**
+     * @brief Initialises the walker
+     * @param options The options of the search
+     */
+    explicit DirectoryWalker(Options options);
+
+    /**
+     * @brief Searches a directory recursively
+     * @details
+     * Directories which can't be read are skipped with a warning.
+     *
+     * @param directory The directory to be searched
+     *
+     * @return The files found, sorted by their path
+     */
+    [[nodiscard]] std::vector<WalkedFile> walk(const std::string &directory)
+    const;
+
+    /**
+     * @brief Matches a path against a glob pattern
+     * @details
+     * Supports "*" and "?" (not matching '/'), "**" (matching across
+     * directories), "[...]" with ranges and "!" or "^" for negation and "\"
+     * to escape a character.
+     *
+     * @param pattern The glob pattern
+     * @param path The path to be matched
+     *
+     * @return True if the whole path matches
+     */
+    [[nodiscard]] static bool matchGlob(std::string_view pattern,
+                                        std::string_view path);
+
+private:
+    /**
+     * @struct Pattern
+     * @brief A pattern of an ignore file
+     */
+    struct Pattern {
+        std::string glob; /** < The pattern without "!" and trailing "/" */
+        bool negated = false; /** < Starts with "!", includes again */
+        bool directoryOnly = false; /** < Ends with "/" */
+        bool anchored = false; /** < Contains "/", matches the whole path */
+    };
+
+    /**
+     * @struct IgnoreList
+     * @brief The patterns of an ignore file and of the directories above
+     */
+    struct IgnoreList {
+        std::shared_ptr<const IgnoreList> parent; /** < The list above */
+        std::string base; /** < Directory of the ignore file */
+        std::vector<Pattern> patterns; /** < Patterns in order */
+    };
+
+    /**
+     * @struct Directory
+     * @brief A directory, which still has to be read
+     */
+    struct Directory {
+        std::string relative; /** < Path relative to the root, ends in '/' */
+        std::shared_ptr<const IgnoreList> ignores; /** < Applying patterns */
+    };
+
+    /**
+     * @brief Parses a line of an ignore file or an exclude pattern
+     * @return The pattern or std::nullopt for empty lines and comments
+     */
+    [[nodiscard]] static std::optional<Pattern> parsePattern(
+        std::string_view line);
+
+    /**
+     * @brief Checks if a pattern matches a path
+     *
+     * @param pattern The pattern to be matched
+     * @param relative The path relative to the directory of the pattern
+     */
+    [[nodiscard]] static bool matches(const Pattern &pattern,
+                                      std::string_view relative);
+
+    /**
+     * @brief Checks if an entry is ignored
+     *
+     * @param ignores The patterns applying to the entry
+     * @param relative Path of the entry relative to the root
+     * @param isDirectory True if the entry is a directory
+     */
+    [[nodiscard]] static bool isIgnored(const IgnoreList *ignores,
+                                        std::string_view relative,
+                                        bool isDirectory);
+
+    /**
+     * @brief Reads a directory
+     *
+     * @param root The searched directory, ending in '/'
+     * @param directory The directory to be read
+     * @param directories Receives the subdirectories
+     * @param files Receives the matching files
+     */
+    void readDirectory(const std::string &root, const Directory &directory,
+                       std::vector<Directory> &directories,
+                       std::vector<WalkedFile> &files) const;
+
+    std::vector<Pattern> includes;
+    std::shared_ptr<const IgnoreList> excludes;
+    std::optional<std::string> ignoreFile;
+};
+} // namespace utilities
+
+#endif // DIRECTORYWALKER_HPP
@@ -306,6 +306,43 @@ public:
     }
 };
 
+/**
+ * @class InvalidSnapshotException
+ * @brief Exception for snapshots which can't be loaded
+ */
+class InvalidSnapshotException : public CustomException {
+private:
+    std::string message;
+
+public:
+    InvalidSnapshotException(const std::string &file,
+                             const std::string &reason) {
+        message = "Invalid snapshot \"" + file + "\": " + reason;
+        LOG_INFO << "InvalidSnapshotException: " << message;
+    }
+    [[nodiscard]] const char *what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+/**
+ * @class ArchiveException
+ * @brief Exception for files which can't be written to an archive
+ */
+class ArchiveException : public CustomException {
+private:
+    std::string message;
+
+public:
+    ArchiveException(const std::string &file, const std::string &reason) {
+        message = "Failed to archive \"" + file + "\": " + reason;
+        LOG_INFO << "ArchiveException: " << message;
+    }
+    [[nodiscard]] const char *what() const noexcept override {
+        return message.c_str();
+    }
+};
+
 } // namespace exceptions
 
 #endif
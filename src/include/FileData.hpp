@@ -15,11 +15,184 @@
 #ifndef FILEDATA_HPP
 #define FILEDATA_HPP
 
+#include "InternTable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 namespace parsing {
+class Optimizer;
+class Snapshot;
+
+/**
+ * @struct Span
+ * @brief Position of a string within the blob of a FileData
+ * @details
+ * If the offset has the bit INTERNED set, the rest of it is the index of
+ * the value within the InternTable instead.
+ */
+struct Span {
+    /**
+     * @brief Marks the offset as index of an interned value
+     * @details
+     * Also the limit of a blob, so no offset within it has the bit set.
+     */
+    static constexpr std::uint32_t INTERNED = 1U << 31;
+
+    std::uint32_t offset = 0; /** < Offset of the first character */
+    std::uint32_t length = 0; /** < Number of characters */
+
+    /**
+     * @brief Checks if the span refers to the InternTable
+     */
+    [[nodiscard]] bool isInterned() const {
+        return (offset & INTERNED) != 0;
+    }
+};
+
+/**
+ * @brief Returns the view of a span
+ *
+ * @param blob The blob the span is part of, unless it is interned
+ * @param span The span
+ *
+ * @return The view of the value
+ */
+[[nodiscard]] inline std::string_view viewOf(std::string_view blob,
+        Span span) {
+    if (span.isInterned()) {
+        return InternTable::getInstance().get(span.offset & ~Span::INTERNED);
+    }
+
+    return blob.substr(span.offset, span.length);
+}
+
+/**
+ * @class SpanIterator
+ * @brief Iterates over a list of spans, returning the views of the spans
+ *
+ * @tparam List The list, which returns the view for an index
+ */
+template <typename List> class SpanIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename List::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    SpanIterator() = default;
+    SpanIterator(const List *list, std::size_t index)
+        : list(list), index(index) {}
+
+    value_type operator*() const {
+        return (*list)[index];
+    }
+
+    SpanIterator &operator++() {
+        ++index;
+        return *this;
+    }
+
+    SpanIterator operator++(int) {
+        SpanIterator previous = *this;
+        ++index;
+        return previous;
+    }
+
+    bool operator==(const SpanIterator &other) const {
+        return index == other.index;
+    }
+
+private:
+    const List *list = nullptr;
+    std::size_t index = 0;
+};
+
+/**
+ * @class StringList
+ * @brief View of a list of strings stored within the blob of a FileData
+ */
+class StringList {
+public:
+    using value_type = std::string_view;
+    using iterator = SpanIterator<StringList>;
+
+    StringList(std::string_view blob, const std::pmr::vector<Span> &spans)
+        : blob(blob), spans(spans) {}
+
+    [[nodiscard]] std::string_view operator[](std::size_t index) const {
+        return viewOf(blob, spans[index]);
+    }
+
+    [[nodiscard]] iterator begin() const {
+        return {this, 0};
+    }
+
+    [[nodiscard]] iterator end() const {
+        return {this, spans.size()};
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return spans.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return spans.empty();
+    }
+
+private:
+    std::string_view blob;
+    const std::pmr::vector<Span> &spans;
+};
+
+/**
+ * @class VariableList
+ * @brief View of the environment variables stored within a FileData
+ * @details
+ * Returns a tuple of key and value for each variable.
+ */
+class VariableList {
+public:
+    using value_type = std::tuple<std::string_view, std::string_view>;
+    using iterator = SpanIterator<VariableList>;
+
+    VariableList(std::string_view blob, const std::pmr::vector<Span> &keys,
+                 const std::pmr::vector<Span> &values)
+        : keys(blob, keys), values(blob, values) {}
+
+    [[nodiscard]] value_type operator[](std::size_t index) const {
+        return {keys[index], values[index]};
+    }
+
+    [[nodiscard]] iterator begin() const {
+        return {this, 0};
+    }
+
+    [[nodiscard]] iterator end() const {
+        return {this, keys.size()};
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return keys.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return keys.empty();
+    }
+
+private:
+    StringList keys;
+    StringList values;
+};
+
 /**
  * @class FileData
  * @brief This class contains all data from the json file.
@@ -28,20 +201,48 @@ namespace parsing {
  * to the attributes of an instance of this class.
  * This class also handles a part of the error handling.
  * - {ReqFunc14}
+ *
+ * All memory is allocated from the given memory resource, which is the
+ * arena of the file since 0.3.0.
+ *
+ * Since 0.3.0 the characters of all values are stored within one blob and
+ * each category only stores the spans of its values. That way creating the
+ * batch file reads through a few contiguous arrays, instead of strings
+ * scattered across the heap. The getters return views into the blob.
+ *
+ * Values of at least InternTable::MIN_SIZE characters are interned instead,
+ * as most of them (e.g. the directories of a toolchain) repeat across the
+ * files of a run. Their spans refer to the InternTable and the blob only
+ * keeps the values seen once, see store().
  */
 class FileData {
 public:
+    /**
+     * @brief The allocator used for all members
+     */
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    /**
+     * @brief Creates an empty instance
+     *
+     * @param allocator The allocator for all members
+     */
+    explicit FileData(const allocator_type &allocator = {})
+        : blob(allocator), commands(allocator), environmentKeys(allocator),
+          environmentValues(allocator), pathValues(allocator) {}
+
     /**
      * @brief Setter for this->outputfile
      * @details
      * Checks that neither the given string is empty, nor that the outputfile
      * is already set and then assigns the newOutputfile to the instance.
+     * If the outputfile doesn't end with ".bat", it is appended.
      *
      * @param newOutputfile The outputfile to be set
      *
      * @throws exceptions::InvalidValueException
      */
-    void setOutputFile(std::string &newOutputfile);
+    void setOutputFile(std::string_view newOutputfile);
 
     /**
      * @brief Setter for this->hideshell
@@ -59,7 +260,7 @@ public:
      *
      * @param newApplication THe application to be set
      */
-    void setApplication(const std::string &newApplication);
+    void setApplication(std::string_view newApplication);
 
     /**
      * @brief Adds a given command to this->commands
@@ -71,21 +272,20 @@ public:
      *
      * @throws exceptions::InvalidValueException
      */
-    void addCommand(const std::string &command);
+    void addCommand(std::string_view command);
 
     /**
-     * @brief Adds a given tuple to this->environmentVariables
+     * @brief Adds a given variable to the environment variables
      * @details
      * Makes sure that neither the key nor the value is empty and then adds
-     * a tuple with both values to the environmentVariables attribute
+     * both values to the environmentKeys and environmentValues attributes
      *
      * @param name The name of the env variable
      * @param value The value of the env variable
      *
      * @throws exceptions::InvalidValueException
      */
-    void addEnvironmentVariable(const std::string &name,
-                                const std::string &value);
+    void addEnvironmentVariable(std::string_view name, std::string_view value);
 
     /**
      * @brief Add's a given value to this->pathValues
@@ -97,14 +297,38 @@ public:
      *
      * @throws exceptions::InvalidValueException
      */
-    void addPathValue(const std::string &pathValue);
+    void addPathValue(std::string_view pathValue);
+
+    /**
+     * @brief Adds all values of a base configuration
+     * @details
+     * Copies the hideshell value, the application (if set) and all entries
+     * of the base into this instance, after the values already added. The
+     * outputfile of the base isn't copied.
+     *
+     * @param base The base configuration, see BaseCache
+     */
+    void extend(const FileData &base);
+
+    /**
+     * @brief Adds the entries of a fragment
+     * @details
+     * Adds the entries after the values already added, like extend(), but
+     * copies the blob of the fragment as a whole instead of each value.
+     * - Added in 0.3.0 for entries bound in chunks, see JsonHandler
+     *
+     * @param fragment The fragment, only its entries are copied
+     *
+     * @throws std::length_error If the blob grows beyond 2 GiB
+     */
+    void concatenate(const FileData &fragment);
 
     /**
      * @brief Getter for this->outputfile
      * @return The assigned outputfile
      */
-    [[nodiscard]] const std::string &getOutputFile() const {
-        return outputfile;
+    [[nodiscard]] std::string_view getOutputFile() const {
+        return view(outputfile);
     }
 
     /**
@@ -119,45 +343,112 @@ public:
      * @brief Getter for this->application
      * @return The assigned application
      */
-    [[nodiscard]] const std::optional<std::string> &getApplication() const {
-        return application;
+    [[nodiscard]] std::optional<std::string_view> getApplication() const {
+        if (!application.has_value()) {
+            return std::nullopt;
+        }
+
+        return view(application.value());
     }
 
     /**
      * @brief Getter for this->commands
-     * @return The vector of assigned commands
+     * @return The list of assigned commands
      */
-    [[nodiscard]] const std::vector<std::string> &getCommands() const {
-        return commands;
+    [[nodiscard]] StringList getCommands() const {
+        return {blob, commands};
     }
 
     /**
-     * @brief Getter for this->environmentVariables
-     * @return The vector of assigned env variables
+     * @brief Getter for the environment variables
+     * @return The list of assigned env variables
      */
-    [[nodiscard]] const std::vector<std::tuple<std::string, std::string>> &
-    getEnvironmentVariables() const {
-        return environmentVariables;
+    [[nodiscard]] VariableList getEnvironmentVariables() const {
+        return {blob, environmentKeys, environmentValues};
     }
 
     /**
      * @brief Getter for this->pathValues
-     * @return The vector of assigned pathValues
+     * @return The list of assigned pathValues
+     */
+    [[nodiscard]] StringList getPathValues() const {
+        return {blob, pathValues};
+    }
+
+    /**
+     * @brief Getter for this->blob
+     * @return The characters of all values
+     */
+    [[nodiscard]] std::string_view getBlob() const {
+        return blob;
+    }
+
+    /**
+     * @brief Size of all values
+     * @return The size of the blob and of the interned values
+     */
+    [[nodiscard]] std::size_t getValueSize() const {
+        return blob.size() + internedSize;
+    }
+
+    /**
+     * @brief Getter for the allocator of all members
+     * @return The allocator given to the constructor
      */
-    [[nodiscard]] const std::vector<std::string> &getPathValues() const {
-        return pathValues;
+    [[nodiscard]] allocator_type get_allocator() const {
+        return commands.get_allocator();
     }
 
 private:
-    std::string outputfile;
-    bool hideShell;
-    std::optional<std::string> application;
+    // Reads and writes the members as a whole
+    friend class Snapshot;
+    // Removes entries in place
+    friend class Optimizer;
+
+    /**
+     * @brief Appends a value to the blob
+     *
+     * @param value The value to be appended
+     *
+     * @return The span of the value within the blob
+     *
+     * @throws std::length_error If the blob grows beyond 2 GiB
+     */
+    Span append(std::string_view value);
+
+    /**
+     * @brief Interns a value or appends it to the blob
+     * @details
+     * Values are appended, if they are too short or the InternTable is full.
+     *
+     * @param value The value to be stored
+     *
+     * @return The span of the value
+     *
+     * @throws std::length_error If the blob grows beyond 2 GiB
+     */
+    Span store(std::string_view value);
+
+    /**
+     * @brief Returns the view of a span
+     */
+    [[nodiscard]] std::string_view view(Span span) const {
+        return viewOf(blob, span);
+    }
+
+    // Characters of all values, which aren't interned
+    std::pmr::string blob;
+    std::size_t internedSize = 0; /** < Characters of the interned values */
+    Span outputfile;
+    bool hideShell = false;
+    std::optional<Span> application;
     // {ReqFunc15}
-    std::vector<std::string> commands;
-    // Tuple<key, value> - {ReqFunc15}
-    std::vector<std::tuple<std::string, std::string>> environmentVariables;
+    std::pmr::vector<Span> commands;
+    // Key and value of the same index belong together - {ReqFunc15}
+    std::pmr::vector<Span> environmentKeys;
+    std::pmr::vector<Span> environmentValues;
     // {ReqFunc15}
-    std::vector<std::string> pathValues;
+    std::pmr::vector<Span> pathValues;
 };
 } // namespace parsing
 
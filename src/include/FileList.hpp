@@ -0,0 +1,129 @@
+/**
+ * @file FileList.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-20
+ * @version 0.3.0
+ * @brief Contains the FileList class.
+ *
+ * @see utilities::FileList
+ *
+ * @see src/sources/FileList.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef FILELIST_HPP
+#define FILELIST_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utilities {
+/**
+ * @class FileList
+ * @brief The files to be converted, which may still be growing
+ * @details
+ * Files can be added while they are already converted, e.g. while reading
+ * a list of files, so the conversion doesn't have to wait for the whole
+ * list. The list is complete once it has been closed.
+ *
+ * The files are accessed by their index. References to added files stay
+ * valid, so they can be used without holding the lock.
+ */
+class FileList {
+public:
+    /**
+     * @brief Size of the chunks a list of files is read in
+     */
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief Adds a file
+     *
+     * @param file The path of the file
+     * @param subdirectory Directory of the batch files relative to the output
+     * directory, see DirectoryWalker
+     */
+    void add(std::string file, std::string subdirectory = "");
+
+    /**
+     * @brief Reads a list of files and adds them one by one
+     * @details
+     * The files are separated by NUL characters (e.g. "find -print0") or by
+     * line breaks, whichever comes first. Empty names are skipped. The files
+     * are added as soon as they have been read.
+     *
+     * @param listFile The list to be read, "-" for the standard input
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    void addFromList(const std::string &listFile);
+
+    /**
+     * @brief Marks the list as complete, wakes up waiting threads
+     */
+    void close();
+
+    /**
+     * @brief Waits until a file has been added
+     *
+     * @param index The index of the file
+     *
+     * @return False if the list has been closed without the file
+     */
+    [[nodiscard]] bool wait(std::size_t index) const;
+
+    /**
+     * @brief Copies the files, which have already been added
+     *
+     * @param index The index of the first file
+     * @param maxCount Maximum number of files to be copied
+     *
+     * @return The paths of up to maxCount files
+     */
+    [[nodiscard]] std::vector<std::string> available(std::size_t index,
+            std::size_t maxCount) const;
+
+    /**
+     * @brief Returns the path of a file, which has already been added
+     */
+    [[nodiscard]] const std::string &operator[](std::size_t index) const;
+
+    /**
+     * @brief Returns the subdirectory of a file, which has been added
+     */
+    [[nodiscard]] const std::string &subdirectory(std::size_t index) const;
+
+    /**
+     * @brief Checks if a file is known to be the last one
+     * @return True if the list is closed and the file is the last one
+     */
+    [[nodiscard]] bool isLast(std::size_t index) const;
+
+    /**
+     * @brief Number of files added so far
+     */
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    /**
+     * @struct Entry
+     * @brief A file within the list
+     */
+    struct Entry {
+        std::string file; /** < The path of the file */
+        std::string subdirectory; /** < See add() */
+    };
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable changed;
+    std::deque<Entry> entries;
+    bool closed = false;
+};
+} // namespace utilities
+
+#endif // FILELIST_HPP
@@ -0,0 +1,125 @@
+/**
+ * @file FileSystemCache.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-21
+ * @version 0.3.0
+ * @brief Contains the FileSystemCache class and the FileStatus struct.
+ *
+ * @see utilities::FileSystemCache
+ *
+ * @see src/sources/FileSystemCache.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef FILESYSTEMCACHE_HPP
+#define FILESYSTEMCACHE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace utilities {
+/**
+ * @struct FileStatus
+ * @brief The information about a path, which is needed by the application
+ */
+struct FileStatus {
+    bool exists = false; /** < True if the path exists */
+    bool isRegularFile = false; /** < True if the path is a regular file */
+    bool isDirectory = false; /** < True if the path is a directory */
+    std::uint64_t size = 0; /** < Size of the file in bytes */
+};
+
+/**
+ * @enum EntryType
+ * @brief Type of an entry of a directory
+ */
+enum class EntryType {
+    FILE, /** < A regular file or a link to one */
+    DIRECTORY, /** < A directory, links to directories are OTHER */
+    OTHER /** < Anything else */
+};
+
+/**
+ * @class FileSystemCache
+ * @brief Retrieves the metadata of paths with as few syscalls as possible
+ * @details
+ * - stat() retrieves everything needed about a path with a single syscall
+ * - isRegularFile() lists the directory of the path once and answers all
+ *   following checks within that directory from the listing. That way
+ *   checking whether thousands of batch files already exist only costs a
+ *   few getdents() calls, instead of one stat per file.
+ *
+ * Files created by the application have to be added using addFile(), as
+ * the listing isn't read again.
+ *
+ * @note The listings are only used on Linux. Other systems usually have
+ * case insensitive file systems, where a listing can't be searched by the
+ * exact name, so every path is checked on it's own.
+ *
+ * @note Not thread safe, every thread has to use it's own cache.
+ */
+class FileSystemCache {
+public:
+    /**
+     * @brief Retrieves the status of a path
+     * @details
+     * Links are followed. Any error is treated as if the path doesn't exist.
+     *
+     * @param path The path to be checked
+     *
+     * @return The status of the path
+     */
+    [[nodiscard]] static FileStatus stat(const std::string &path);
+
+    /**
+     * @brief Lists a directory
+     *
+     * @param path The directory to be listed, ending in a separator
+     * @param entry Called with the name and type of every entry
+     *
+     * @return False if the directory can't be read
+     */
+    static bool listDirectory(const std::string &path,
+                              const std::function<void(std::string_view, EntryType)> &entry);
+
+    /**
+     * @brief Checks if a path is a regular file, using the listings
+     *
+     * @param path The path to be checked
+     *
+     * @return True if the path is a regular file
+     */
+    [[nodiscard]] bool isRegularFile(const std::string &path);
+
+    /**
+     * @brief Adds a regular file, which has been created since the listing
+     *
+     * @param path The path of the file
+     */
+    void addFile(const std::string &path);
+
+private:
+    /**
+     * @brief Splits a path into the directory (with a separator) and name
+     */
+    [[nodiscard]] static std::pair<std::string, std::string_view>
+    split(std::string_view path);
+
+    /**
+     * @brief Returns the listing of a directory, listing it if needed
+     *
+     * @param directory The directory, empty for the working directory
+     *
+     * @return The names of all regular files within the directory
+     */
+    std::unordered_set<std::string> &listing(const std::string &directory);
+
+    std::unordered_map<std::string, std::unordered_set<std::string>> listings;
+};
+} // namespace utilities
+
+#endif // FILESYSTEMCACHE_HPP
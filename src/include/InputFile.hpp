@@ -0,0 +1,166 @@
+/**
+ * @file InputFile.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-06
+ * @version 0.3.0
+ * @brief Contains the InputFile class.
+ *
+ * @see utilities::InputFile
+ *
+ * @see src/sources/InputFile.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef INPUTFILE_HPP
+#define INPUTFILE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace utilities {
+/**
+ * @class InputFile
+ * @brief Loads the content of a file into one contiguous range.
+ * @details
+ * The whole file is read exactly once and can then be handed to the parser
+ * as a pair of pointers, without copying it into further strings.
+ * - Small files are read with a single read() into a buffer, which is taken
+ *   from a pool shared by all threads and returned to it once the InputFile
+ *   is destroyed. That way the buffers are reused for every file, even if
+ *   it is released on another thread than it was read on.
+ * - Large files are mapped into memory using mmap() with MADV_SEQUENTIAL.
+ *
+ * @note On Windows the file is always read into a buffer.
+ */
+class InputFile {
+public:
+    /**
+     * @brief Files with at least this size (in bytes) will be mapped
+     */
+    static constexpr std::size_t MMAP_THRESHOLD = 64 * 1024;
+
+    /**
+     * @brief Loads the given file
+     *
+     * @param filename The file to be loaded
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    explicit InputFile(const std::string &filename);
+
+    /**
+     * @brief Creates an InputFile with an uninitialised buffer
+     * @details
+     * This is used by readers such as IoUring, which fill the buffer
+     * themselves using writableData() and then set the final size using
+     * setSize().
+     *
+     * @param size The size of the buffer in bytes
+     *
+     * @return The InputFile owning the buffer
+     */
+    static InputFile allocate(std::size_t size);
+
+    /**
+     * @brief Reads the next chunk of the standard input
+     * @details
+     * Returns as soon as any data is available, so that the data can be
+     * handled while the writing process is still running.
+     *
+     * @param buffer The buffer to be filled
+     * @param size The size of the buffer in bytes
+     *
+     * @return Number of bytes read, 0 at the end of the input
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    static std::size_t readStandardInput(char *buffer, std::size_t size);
+
+    /**
+     * @brief Unmaps the file or returns the buffer to the pool
+     */
+    ~InputFile();
+
+    InputFile(const InputFile &) = delete;
+    InputFile &operator=(const InputFile &) = delete;
+    InputFile(InputFile &&other) noexcept;
+    InputFile &operator=(InputFile &&other) noexcept;
+
+    /**
+     * @brief Writable pointer to the buffer of an allocated InputFile
+     */
+    [[nodiscard]] char *writableData() {
+        return buffer.get();
+    }
+
+    /**
+     * @brief Sets the number of valid bytes of an allocated InputFile
+     * @param newSize The number of bytes, which have been read
+     */
+    void setSize(std::size_t newSize) {
+        length = newSize;
+    }
+
+    /**
+     * @brief Pointer to the first character of the file
+     */
+    [[nodiscard]] const char *begin() const {
+        return data;
+    }
+
+    /**
+     * @brief Pointer behind the last character of the file
+     */
+    [[nodiscard]] const char *end() const {
+        return data + length;
+    }
+
+    /**
+     * @brief Getter for the size of the file
+     * @return The size of the file in bytes
+     */
+    [[nodiscard]] std::size_t size() const {
+        return length;
+    }
+
+    /**
+     * @brief The content of the file as a string_view
+     */
+    [[nodiscard]] std::string_view view() const {
+        return {data, length};
+    }
+
+private:
+    /**
+     * @brief Constructor for allocate()
+     */
+    InputFile() = default;
+
+    /**
+     * @brief Unmaps the file or returns the buffer to the pool
+     */
+    void release();
+
+    /**
+     * @brief Takes a buffer which fits the given size from the pool
+     * @details
+     * If the size is larger than a pooled buffer, a dedicated buffer is
+     * allocated instead, which will not be returned to the pool.
+     *
+     * @param size The size needed in bytes
+     *
+     * @return Pointer to the writable buffer
+     */
+    char *acquireBuffer(std::size_t size);
+
+    const char *data = nullptr;
+    std::size_t length = 0;
+    bool mapped = false; /** < True if data points to a mapping */
+    std::unique_ptr<char[]> buffer; /** < Buffer if the file was read */
+    std::size_t bufferCapacity = 0;
+};
+} // namespace utilities
+
+#endif // INPUTFILE_HPP
@@ -0,0 +1,173 @@
+/**
+ * @file InternTable.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-27
+ * @version 0.3.0
+ * @brief Contains the InternTable class.
+ *
+ * @see parsing::InternTable
+ *
+ * @see src/sources/InternTable.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef INTERNTABLE_HPP
+#define INTERNTABLE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parsing {
+/**
+ * @class InternTable
+ * @brief The values repeated across the files of a run, stored once
+ * @details
+ * Most configurations of a corpus share long values, e.g. the directories
+ * of a toolchain. Instead of copying such a value into the blob of every
+ * FileData, it is interned once per run and the FileData only keeps its
+ * index, see Span::INTERNED.
+ *
+ * The table is shared by all threads:
+ * - Interning a value locks one of SHARDS shards, chosen by the hash of the
+ *   value, so threads interning different values rarely wait for each
+ *   other.
+ * - Retrieving the value of an index doesn't lock at all, as interned
+ *   values are never moved or removed until the end of the run.
+ *
+ * Unlike the arenas of the files, the table isn't reset after each file.
+ * It is therefore bounded by MAX_BYTES and MAX_ENTRIES, once it is full
+ * further values are stored within the blob as before.
+ *
+ * This class is singleton, like BaseCache.
+ */
+class InternTable {
+public:
+    /**
+     * @brief Minimum size of a value to be interned
+     * @details
+     * Shorter values are stored within the blob, as they take about as much
+     * space as their entry within the table.
+     */
+    static constexpr std::size_t MIN_SIZE = 16;
+
+    /**
+     * @brief Maximum number of characters of all interned values
+     */
+    static constexpr std::size_t MAX_BYTES = 16 * 1024 * 1024;
+
+    /**
+     * @brief Maximum number of interned values
+     */
+    static constexpr std::uint32_t MAX_ENTRIES = 256 * 1024;
+
+    /**
+     * @struct Statistics
+     * @brief Interned values, reported by --stats
+     */
+    struct Statistics {
+        std::uint64_t values = 0; /** < Distinct values interned */
+        std::uint64_t bytes = 0; /** < Characters of the interned values */
+        std::uint64_t reused = 0; /** < Values found within the table */
+    };
+
+    /**
+     * @brief Get the instance of this class
+     *
+     * @return Reference to the instance of this class
+     */
+    static InternTable &getInstance();
+
+    /**
+     * @brief Interns a value
+     *
+     * @param value The value to be interned
+     *
+     * @return The index of the value or std::nullopt if it is too short or
+     * the table is full
+     */
+    [[nodiscard]] std::optional<std::uint32_t> intern(std::string_view value);
+
+    /**
+     * @brief Retrieves an interned value
+     *
+     * @param index The index returned by intern()
+     *
+     * @return The value, valid until the end of the run
+     */
+    [[nodiscard]] std::string_view get(std::uint32_t index) const {
+        return this->blocks[index / BLOCK_SIZE].load(std::memory_order_acquire)
+               [index % BLOCK_SIZE];
+    }
+
+    /**
+     * @brief Getter for the statistics of the run
+     */
+    [[nodiscard]] Statistics getStatistics() const;
+
+    InternTable(const InternTable &) = delete;
+    InternTable &operator=(const InternTable &) = delete;
+
+private:
+    /**
+     * @brief Number of shards, each with its own lock
+     */
+    static constexpr std::size_t SHARDS = 16;
+
+    /**
+     * @brief Number of values within a block of the index
+     */
+    static constexpr std::size_t BLOCK_SIZE = 4096;
+
+    /**
+     * @brief Size of the chunks the characters are stored in
+     */
+    static constexpr std::size_t CHUNK_SIZE = 256 * 1024;
+
+    /**
+     * @struct Shard
+     * @brief The values with the same hash modulo SHARDS
+     */
+    struct Shard {
+        std::mutex mutex; /** < Guards all other members */
+        std::unordered_map<std::string_view, std::uint32_t> indices;
+        std::vector<std::unique_ptr<char[]>> chunks; /** < The characters */
+        char *free = nullptr; /** < Unused part of the last chunk */
+        std::size_t freeSize = 0; /** < Size of the unused part */
+    };
+
+    InternTable() = default;
+
+    /**
+     * @brief Copies a value into the chunks of a shard, the shard has to be
+     * locked
+     *
+     * @return The copy, which is never moved
+     */
+    static std::string_view store(Shard &shard, std::string_view value);
+
+    /**
+     * @brief Returns the block of the index, allocating it if needed
+     */
+    std::string_view *block(std::size_t block);
+
+    std::array<Shard, SHARDS> shards;
+    // The values by their index, read without locking
+    std::array<std::atomic<std::string_view *>, MAX_ENTRIES / BLOCK_SIZE>
+    blocks{};
+    std::mutex blocksMutex; /** < Guards allocating blocks */
+    std::vector<std::unique_ptr<std::string_view[]>> ownedBlocks;
+    std::atomic<std::uint32_t> count{0}; /** < Indices handed out */
+    std::atomic<std::size_t> bytes{0}; /** < Characters stored */
+    std::atomic<std::uint64_t> reused{0}; /** < Values found */
+};
+} // namespace parsing
+
+#endif // INTERNTABLE_HPP
@@ -0,0 +1,178 @@
+/**
+ * @file IoUring.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-08
+ * @version 0.3.0
+ * @brief Contains the IoUring class and the OutputFile struct.
+ *
+ * @see utilities::IoUring
+ *
+ * @see src/sources/IoUring.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef IOURING_HPP
+#define IOURING_HPP
+
+#include "FileSystemCache.hpp"
+#include "InputFile.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace utilities {
+/**
+ * @struct OutputFile
+ * @brief A file which should be written
+ */
+struct OutputFile {
+    std::string fileName; /** < Path of the file */
+    std::string_view content; /** < Content to be written */
+};
+
+/**
+ * @class IoUring
+ * @brief Batches file I/O of many files using io_uring
+ * @details
+ * When many small files are converted, most of the time is spent within
+ * the syscalls for stat, open, read, write and close of every single file.
+ * This class submits those operations for up to BATCH_SIZE files at once to
+ * the kernel using io_uring, so that only a few syscalls are needed per batch.
+ *
+ * The class only accelerates the I/O. If an operation fails for a file, the
+ * result for that file is empty and the caller is expected to fall back to
+ * the portable path, which will then also report the error.
+ *
+ * @note io_uring is only available on Linux. If the application is built
+ * without io_uring support or the kernel doesn't allow it, isAvailable()
+ * returns false.
+ */
+class IoUring {
+public:
+    /**
+     * @brief Number of files which are processed within one batch
+     */
+    static constexpr std::size_t BATCH_SIZE = 128;
+
+    /**
+     * @brief Checks if io_uring can be used
+     * @details
+     * Tries to set up a ring once and checks that all needed operations are
+     * supported by the kernel. The result is cached.
+     *
+     * @return True if io_uring can be used
+     */
+    [[nodiscard]] static bool isAvailable();
+
+    /**
+     * @brief Sets up the ring
+     *
+     * @throw std::runtime_error If the ring can't be set up
+     */
+    IoUring();
+
+    /**
+     * @brief Unmaps and closes the ring
+     */
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    /**
+     * @brief Retrieves the status of all given paths
+     *
+     * @param paths The paths to be checked
+     *
+     * @return The status of each path, in the same order
+     */
+    std::vector<FileStatus> statFiles(const std::vector<std::string> &paths);
+
+    /**
+     * @brief Reads all given files
+     * @details
+     * The files are checked and opened within one batch, then read and
+     * closed within a second batch. Files which are larger than
+     * InputFile::MMAP_THRESHOLD are not read, as mapping them is faster.
+     *
+     * @param paths The files to be read
+     *
+     * @return The content of each file or std::nullopt if it wasn't read
+     */
+    std::vector<std::optional<InputFile>>
+    readFiles(const std::vector<std::string> &paths);
+
+    /**
+     * @brief Writes all given files
+     * @details
+     * Existing files are truncated.
+     *
+     * @param files The files to be written
+     *
+     * @return True for each file, which was completely written
+     */
+    std::vector<bool> writeFiles(const std::vector<OutputFile> &files);
+
+private:
+    /**
+     * @brief Opens all given paths
+     *
+     * @param paths The paths to be opened
+     * @param flags Flags for openat()
+     *
+     * @return The file descriptor or a negative error for each path
+     */
+    std::vector<int> openFiles(const std::vector<const char *> &paths,
+                               int flags);
+
+    /**
+     * @brief Unmaps and closes everything which has been set up
+     */
+    void teardown();
+
+    /**
+     * @brief Queues an operation
+     * @details
+     * Returns a cleared submission queue entry. At most the size of the
+     * queue can be queued before calling submitAndWait().
+     *
+     * @param userData Value which identifies the completion
+     *
+     * @return Pointer to the entry to be filled
+     */
+    struct io_uring_sqe *queue(std::uint64_t userData);
+
+    /**
+     * @brief Submits all queued entries and waits for their completion
+     * @details
+     * The given callback is called with the user data and result of
+     * every completion.
+     */
+    template <typename Callback> void submitAndWait(Callback &&onCompletion);
+
+    int ringFd = -1;
+    unsigned queued = 0; /** < Entries queued since the last submit */
+    unsigned entries = 0; /** < Size of the submission queue */
+    void *sqRing = nullptr;
+    void *cqRing = nullptr;
+    std::size_t sqRingSize = 0;
+    std::size_t cqRingSize = 0;
+    struct io_uring_sqe *sqes = nullptr;
+    std::size_t sqesSize = 0;
+    unsigned *sqTail = nullptr;
+    unsigned *sqMask = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned *cqMask = nullptr;
+    struct io_uring_cqe *cqes = nullptr;
+};
+} // namespace utilities
+
+#endif // IOURING_HPP
@@ -16,10 +16,15 @@
 #define JSONHANDLER_HPP
 
 #include "FileData.hpp"
+#include "InputFile.hpp"
 #include "LoggingWrapper.hpp"
 #include <jsoncpp/json.h>
 
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
 
 /**
  * @namespace parsing
@@ -41,7 +46,10 @@ namespace parsing {
  * @details
  * This file uses the jsoncpp library to parse all data from a json
  * file, validate it to some degree.
+ * The placeholders within commands, paths, values and applications are
+ * expanded before they are validated (since 0.3.0).
  *
+ * @see TemplateExpander
  * @see https://github.com/open-source-parsers/jsoncpp
  */
 class JsonHandler {
@@ -63,6 +71,33 @@ public:
      * @param filename Name of the json file
      */
     explicit JsonHandler(const std::string &filename);
+    /**
+     * @brief Constructor for an already loaded file
+     * @details
+     * This constructor parses the given content instead of loading the file
+     * itself. This is used when files are read in batches.
+     *
+     * @param filename Name of the json file
+     * @param input The content of the json file
+     * @param resource Memory resource for the FileData, e.g. an arena
+     */
+    JsonHandler(const std::string &filename, const utilities::InputFile &input,
+                std::pmr::memory_resource *resource =
+                    std::pmr::get_default_resource());
+    /**
+     * @brief Constructor for a part of a file
+     * @details
+     * Used for the configurations within a file with multiple ones.
+     *
+     * @param filename Name of the configuration, used for errors
+     * @param content The json text of the configuration
+     * @param resource Memory resource for the FileData, e.g. an arena
+     *
+     * @see JsonSplitter
+     */
+    JsonHandler(const std::string &filename, std::string_view content,
+                std::pmr::memory_resource *resource =
+                    std::pmr::get_default_resource());
     /**
      * @brief Retrieve the data from the json file
      * @details
@@ -74,6 +109,78 @@ public:
      */
     std::shared_ptr<FileData> getFileData();
 
+    /**
+     * @brief Retrieve the data of a base configuration
+     * @details
+     * Like getFileData(), but a base doesn't need an outputfile, as the
+     * outputfile is never inherited.
+     * - Added in 0.3.0
+     *
+     * @return Pointer to the FileData Object with the parsed data from json
+     *
+     * @see BaseCache
+     */
+    std::shared_ptr<const FileData> getBaseFileData();
+
+    /**
+     * @brief Retrieve the names of the profiles
+     * @details
+     * The names are sorted, which is the order the profiles are created in.
+     * - Added in 0.3.0
+     *
+     * @return The names of all profiles, empty if there are none
+     */
+    [[nodiscard]] std::vector<std::string> getProfiles() const;
+
+    /**
+     * @brief Check if the configuration extends bases
+     * @details
+     * Bases are resolved relative to the file, so the same configuration
+     * may create different batch files within different directories.
+     * - Added in 0.3.0
+     *
+     * @return True if the extends key is given
+     */
+    [[nodiscard]] bool hasBases() const;
+
+    /**
+     * @brief Retrieve the data of a profile
+     * @details
+     * The profile extends the shared part of the configuration (see
+     * getBaseFileData()) like a base: its outputfile, hideshell and
+     * application replace the shared ones and its entries are added after
+     * the shared entries. Without an outputfile of its own, the name of the
+     * profile is appended to the shared one, e.g. "app-debug.bat".
+     *
+     * This instance is only read, so all profiles can be created
+     * concurrently.
+     * - Added in 0.3.0
+     *
+     * @param profile The name of the profile
+     * @param shared The data of the shared part
+     * @param resource Memory resource for the FileData, e.g. an arena
+     *
+     * @return Pointer to the FileData Object of the profile
+     */
+    [[nodiscard]] std::shared_ptr<FileData> getProfileFileData(
+        const std::string &profile, const FileData &shared,
+        std::pmr::memory_resource *resource) const;
+
+    /**
+    * @brief Check if a string contains a bad character
+    * @details
+    * This method checks if a given string contains a bad character.
+    * Bad characters are declared in a set within the function. This is done
+    * to ensure, that no characters such as line breaks, break the later
+    * generated batch file.
+    * - Public since 0.3.0, as snapshots are checked as well
+    *
+    * @param str The string to be checked
+    *
+    * @bool If the string contains a bad char or not
+    */
+    [[nodiscard]] static bool containsBadCharacter(const std::string_view &str);
+
 private:
     /**
      * @brief Parses the given json file
@@ -83,6 +190,7 @@ private:
      * It then validates the keys of the instance using the KeyValidator class.
      *
      * @param filename The name of the file wich should be parsed
+     * @param content The content of the file
      * @return A shared pointer to the Json::Value instance
      *
      * @see KeyValidator::validateKeys()
@@ -91,7 +199,19 @@ private:
      * @throw exceptions::InvalidKeyException
      */
     [[nodiscard]] static std::shared_ptr<Json::Value>
-    parseFile(const std::string &filename);
+    parseFile(const std::string &filename, std::string_view content);
+    /**
+     * @brief Merges the base configurations into this->data
+     * @details
+     * Retrieves the bases named by the extends key (a path or a list of
+     * paths) from the BaseCache and merges them in the given order, as if
+     * their entries were written before the own entries. The hideshell and
+     * application values of the bases are used, unless the file sets them.
+     * - Added in 0.3.0
+     *
+     * @see BaseCache
+     */
+    void assignBases() const;
     /**
      * @brief Assigns the outputfile to this->data
      * @details
@@ -99,9 +219,11 @@ private:
      * the file doesn't already exist.
      * - {ReqFunc8}
      *
+     * @param defaultOutputFile Used if the outputfile isn't given
+     *
      * @throw exceptions::FileExistsException
      */
-    void assignOutputFile() const;
+    void assignOutputFile(std::string_view defaultOutputFile = {}) const;
     /**
      * @brief Assigns the hideshell value to this->data
      * @details
@@ -125,6 +247,8 @@ private:
      * calls the relevant method depending on it's type.
      * All "type" keys should be valid by this point.
      * - {ReqFunc10}
+     * - Large arrays are bound in chunks on several threads since 0.3.0,
+     *   the order of the entries and the first error stay the same
      *
      * @param entry Json::Value containing an array with entries
      *
@@ -132,51 +256,78 @@ private:
      */
     void assignEntries() const;
     /**
-     * @brief Assigns an command to this->data
+     * @brief Assigns an entry depending on it's type
+     * @details
+     * - Added in 0.3.0
+     * @param entry The entry
+     * @param data This->data or the fragment of a chunk
+     *
+     * @throw exceptions::UnreachableCodeException
+     */
+    static void assignEntry(const Json::Value &entry, FileData &data);
+    /**
+     * @brief Assigns an command to the data
      * @details
      * - {ReqFunc12}
      * @param entry The entry with the command
+     * @param data This->data or the fragment of a chunk
      */
-    void assignCommand(const Json::Value &entry) const;
+    static void assignCommand(const Json::Value &entry, FileData &data);
     /**
-     * @brief Assigns an environmentVariable to this->data
+     * @brief Assigns an environmentVariable to the data
      * @details
      * - {ReqFunc11}
      * @param entry The entry with the environmentVariable
+     * @param data This->data or the fragment of a chunk
      */
-    void assignEnvironmentVariable(const Json::Value &entry) const;
+    static void assignEnvironmentVariable(const Json::Value &entry,
+                                          FileData &data);
     /**
-     * @brief Assigns a path value to this->data
+     * @brief Assigns a path value to the data
      * @details
      * - {ReqFunc13}
      * @param entry The entry with the path value
+     * @param data This->data or the fragment of a chunk
      */
-    void assignPathValue(const Json::Value &entry) const;
+    static void assignPathValue(const Json::Value &entry, FileData &data);
     /**
      * @brief Creates the FileData instance
      * @details
      * Instantiates the FileData instance, calls all nessecary functions and
      * returns a shared pointer to it.
+     * The instance is allocated from this->resource.
+     *
+     * @param isBase True if the outputfile may be missing
      *
      * @return Pointer to the created instance of FileData
      */
-    std::shared_ptr<FileData> createFileData();
+    std::shared_ptr<FileData> createFileData(bool isBase = false);
 
     /**
-    * @brief Check if a string contains a bad character
-    * @details
-    * This method checks if a given string contains a bad character.
-    * Bad characters are declared in a set within the function. This is done
-    * to ensure, that no characters such as line breaks, break the later
-    * generated batch file.
-    *
-    * @param str The string to be checked
-    *
-    * @bool If the string contains a bad char or not
-    */
-    [[nodiscard]] static bool containsBadCharacter(const std::string_view &str);
-    std::shared_ptr<Json::Value> root;
+     * @brief Retrieves a string value without copying it
+     * @details
+     * Looks up the key like Json::Value::get() with an empty default value.
+     * If the value is a string, a view of the string within the Json::Value
+     * is returned. Other values are converted using asString() and stored
+     * within the given string.
+     * - Added in 0.3.0, so each value is only copied into the FileData
+     *
+     * @param object The object containing the key
+     * @param key The key of the value
+     * @param converted Storage for values, which aren't strings
+     *
+     * @return View of the value, valid as long as object and converted
+     *
+     * @throw Json::LogicError If the value can't be converted to a string
+     */
+    [[nodiscard]] static std::string_view getString(const Json::Value &object,
+            std::string_view key,
+            std::string &converted);
+
+    std::string filename;
+    std::shared_ptr<const Json::Value> root;
     std::shared_ptr<FileData> data;
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource();
 };
 } // namespace parsing
 
@@ -0,0 +1,153 @@
+/**
+ * @file JsonSplitter.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-17
+ * @version 0.3.0
+ * @brief Contains the JsonSplitter class.
+ *
+ * @see parsing::JsonSplitter
+ *
+ * @see src/sources/JsonSplitter.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef JSONSPLITTER_HPP
+#define JSONSPLITTER_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace parsing {
+/**
+ * @class JsonSplitter
+ * @brief Splits a file with many configurations into its elements
+ * @details
+ * Besides a single configuration, a file may contain:
+ * - A top level array of configurations
+ * - Configurations one after the other, e.g. JSON Lines (".jsonl")
+ *
+ * The splitter only scans the nesting depth of brackets outside of strings
+ * to find where each element ends, the elements are parsed one by one
+ * afterwards. That way only a single element has to be parsed at once,
+ * instead of the whole file. Syntax errors within an element are left to
+ * the parser.
+ *
+ * @see JsonHandler
+ */
+class JsonSplitter {
+public:
+    /**
+     * @enum Layout
+     * @brief How the configurations are stored within the file
+     */
+    enum class Layout {
+        SINGLE, /** < One configuration, the whole content is one element */
+        ARRAY, /** < A top level array of configurations */
+        LINES /** < Configurations one after the other */
+    };
+
+    /**
+     * @struct Element
+     * @brief A configuration within the file
+     */
+    struct Element {
+        std::string_view content; /** < The text of the configuration */
+        std::size_t index = 0; /** < Index within the file, starting at 0 */
+        std::size_t line = 1; /** < Line the configuration starts in */
+    };
+
+    /**
+     * @struct ScanState
+     * @brief State of scan(), so a value can be scanned piece by piece
+     */
+    struct ScanState {
+        std::size_t depth = 0; /** < Number of open brackets */
+        bool inString = false; /** < Within a string */
+        bool escaped = false; /** < The last character was a backslash */
+    };
+
+    /**
+     * @brief Detects the layout of the content
+     *
+     * @param filename Name of the file, used for errors
+     * @param content The content of the file, which has to outlive this
+     */
+    JsonSplitter(std::string filename, std::string_view content);
+
+    /**
+     * @brief Getter for this->layout
+     * @return The detected layout
+     */
+    [[nodiscard]] Layout getLayout() const {
+        return layout;
+    }
+
+    /**
+     * @brief Finds the next element
+     *
+     * @return The element or std::nullopt if there are no elements left
+     *
+     * @throw exceptions::ParsingException If the elements are not separated
+     * correctly
+     */
+    [[nodiscard]] std::optional<Element> next();
+
+    /**
+     * @brief Scans for the end of a value
+     * @details
+     * Objects and arrays end with their closing bracket, other values at the
+     * next whitespace, comma or closing bracket. Used to read values from a
+     * stream, where the content may end within the value.
+     *
+     * @param content The content to be scanned
+     * @param position Position to continue at, the first character of the
+     * value for a new state
+     * @param state The state, which is updated for the scanned content
+     *
+     * @return Position behind the value or std::nullopt if the content ends
+     * within the value
+     */
+    [[nodiscard]] static std::optional<std::size_t>
+    scan(std::string_view content, std::size_t position, ScanState &state);
+
+private:
+    /**
+     * @brief Skips whitespace
+     *
+     * @param position Position to start at
+     *
+     * @return Position of the next other character or the end
+     */
+    [[nodiscard]] std::size_t skipWhitespace(std::size_t position) const;
+
+    /**
+     * @brief Finds the end of the value starting at the given position
+     *
+     * @param position Position of the first character of the value
+     *
+     * @return Position behind the value, the end for unterminated values
+     *
+     * @see scan()
+     */
+    [[nodiscard]] std::size_t findEnd(std::size_t position) const;
+
+    /**
+     * @brief Creates the element between both positions
+     */
+    [[nodiscard]] Element createElement(std::size_t begin, std::size_t end);
+
+    const std::string filename;
+    const std::string_view content;
+    Layout layout = Layout::SINGLE;
+    std::size_t position = 0;
+    std::size_t index = 0;
+    // Lines are counted up to lineStart, only when an element is created
+    std::size_t line = 1;
+    std::size_t lineStart = 0;
+    bool done = false;
+};
+} // namespace parsing
+
+#endif // JSONSPLITTER_HPP
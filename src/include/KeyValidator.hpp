@@ -16,6 +16,7 @@
 
 #include "jsoncpp/value.h"
 #include <optional>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 namespace parsing {
@@ -47,12 +48,14 @@ public:
      *
      * @param root The Json::Value object to be validated.
      * @param filename The filename from which 'root' is from.
+     * @param content The content of the file, used to find line numbers.
      *
      * @return A vector with tuples, containing the line and name of invalid
      * types.
      */
     std::vector<std::tuple<int, std::string>>
-    validateKeys(const Json::Value &root, const std::string &filename);
+    validateKeys(const Json::Value &root, const std::string &filename,
+                 std::string_view content);
 
 private:
     /**
@@ -63,12 +66,14 @@ private:
      *
      * @param root The Json::Value object to be validated.
      * @param filename The filename from which 'root' is from.
+     * @param content The content of the file
      *
      * @return A vector with tuples, containing the line and name of invalid
      * types.
      */
     std::vector<std::tuple<int, std::string>>
-    getWrongKeys(const Json::Value &root, const std::string &filename) const;
+    getWrongKeys(const Json::Value &root, const std::string &filename,
+                 std::string_view content) const;
 
     /**
      * @brief Validates types from the entries array.
@@ -81,7 +86,7 @@ private:
      * @note Unnecessary keys within a type entry, don't cause an exception and
      * are ignored.
      *
-     * @param filename The filename from which 'entry' is from
+     * @param content The content of the file from which 'entry' is from
      * @param entry The entry to be validated
      * @param entryKeys The keys of the entry
      *
@@ -89,7 +94,7 @@ private:
      * @throw exceptions::InvalidTypeException
      * @throw exceptions::MissingKeyException
      */
-    void validateTypes(const std::string &filename, const Json::Value &entry,
+    void validateTypes(std::string_view content, const Json::Value &entry,
                        const std::unordered_set<std::string> &entryKeys);
 
     /**
@@ -99,37 +104,103 @@ private:
      * the keys are part of the validEntryKeys attribute.
      *
      *
-     * @param filename The filename from which the entries are from
+     * @param content The content of the file from which the entries are from
      * @param entryKeys The keys of the entries
      *
      * @return A vector with tuples, containing the line and name of invalid
      * entrie keys
      */
     std::vector<std::tuple<int, std::string>>
-    validateEntries(const std::string &filename,
+    validateEntries(std::string_view content,
                     const std::unordered_set<std::string> &entryKeys) const;
 
     /**
      * @brief Get the line of an unknown key
      * @details
-     * This method goes through each line of the given file and checks if the
-     * line contains the given key. Returns std::nullopt if the file can't be
-     * opened or the key was not found.
+     * This method searches the already loaded content of the file for the
+     * given key as a whole word and counts the lines up to the first match.
+     * Returns std::nullopt if the key was not found.
+     * - Changed in 0.3.0 to not read the file a second time
+     * - Changed in 0.3.0 to search without std::regex, so files can be
+     *   validated on several threads
      *
-     * @param filename The filename which should contain the key
+     * @param content The content of the file which should contain the key
      * @param wrongKey The key to be searched for
      *
      * @return The line of the key, if it was found
      */
-    static std::optional<int> getUnknownKeyLine(const std::string &filename,
+    static std::optional<int> getUnknownKeyLine(std::string_view content,
             const std::string &wrongKey);
 
+    /**
+     * @brief Validates the entries array of a configuration or profile
+     * @details
+     * Validates the keys of each entry using validateEntries() and their
+     * types using validateTypes().
+     * - Added in 0.3.0, as profiles contain entries as well
+     * - Large arrays are validated in chunks on several threads since
+     *   0.3.0, the wrong keys and the first error stay the same
+     *
+     * @see utilities::ParallelChunks
+     * @param object The configuration or profile containing the entries
+     * @param content The content of the file
+     * @param wrongKeys The wrong keys found are added to it
+     */
+    void validateEntryList(const Json::Value &object, std::string_view content,
+                           std::vector<std::tuple<int, std::string>> &wrongKeys);
+
+    /**
+     * @brief Validates the keys and the type of a single entry
+     * @details
+     * - Added in 0.3.0
+     *
+     * @param entry The entry to be validated
+     * @param content The content of the file
+     * @param wrongKeys The wrong keys found are added to it
+     */
+    void validateEntry(const Json::Value &entry, std::string_view content,
+                       std::vector<std::tuple<int, std::string>> &wrongKeys);
+
+    /**
+     * @brief Validates the profiles of a configuration
+     * @details
+     * The profiles have to be an object containing every profile by its name.
+     * A profile may only contain the keys of validProfileKeys.
+     * - Added in 0.3.0
+     *
+     * @param profiles The value of the profiles key
+     * @param content The content of the file
+     * @param wrongKeys The wrong keys found are added to it
+     *
+     * @throw exceptions::InvalidValueException
+     */
+    void validateProfiles(const Json::Value &profiles, std::string_view content,
+                          std::vector<std::tuple<int, std::string>> &wrongKeys);
+
+    /**
+     * @brief Validates the value of the extends key
+     * @details
+     * The value has to be a path or an array of paths, none of them empty.
+     * - Added in 0.3.0
+     *
+     * @param extends The value of the extends key
+     *
+     * @throw exceptions::InvalidValueException
+     */
+    static void validateExtends(const Json::Value &extends);
+
     /**
      * @note Changed from vector to unordered_set in 0.2.1 - as this shoud improve
      * lookup performance from O(n) to O(1)
      */
     std::unordered_set<std::string> validKeys = {"outputfile", "hideshell",
-        "entries", "application"
+        "entries", "application", "extends", "profiles"
+    };
+    /**
+     * @note A profile can't extend bases or contain profiles itself
+     */
+    std::unordered_set<std::string> validProfileKeys = {"outputfile",
+        "hideshell", "entries", "application"
     };
     /**
      * @note Changed from vector to unordered_set in 0.2.1 - as this shoud improve
@@ -0,0 +1,166 @@
+/**
+ * @file LargestFirstQueue.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-27
+ * @version 0.3.0
+ * @brief Contains the LargestFirstQueue class template.
+ *
+ * @see utilities::LargestFirstQueue
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef LARGESTFIRSTQUEUE_HPP
+#define LARGESTFIRSTQUEUE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace utilities {
+/**
+ * @class LargestFirstQueue
+ * @brief A thread safe queue with a maximum size, which returns the largest
+ * element first
+ * @details
+ * Used like BoundedQueue, but each element has a size and pop() returns
+ * the largest element waiting. Elements of the same size are returned in
+ * the order they were added in. That way a large element added late doesn't
+ * wait behind many small ones.
+ *
+ * The elements are kept in a binary heap behind a single mutex, so adding
+ * and taking an element takes O(log n) and all threads take turns. As the
+ * elements are whole configurations, the lock is held for a tiny fraction
+ * of the time it takes to convert one.
+ *
+ * The order only applies to the elements waiting within the queue, which
+ * holds at most capacity elements. The order of the files themselves is
+ * decided before they are passed on, see main().
+ *
+ * After close() was called, push() fails and pop() returns the remaining
+ * elements followed by std::nullopt.
+ *
+ * @tparam T The type of the elements
+ */
+template <typename T> class LargestFirstQueue {
+public:
+    /**
+     * @brief Creates an empty queue
+     * @param capacity The maximum number of elements within the queue
+     */
+    explicit LargestFirstQueue(std::size_t capacity) : capacity(capacity) {}
+
+    /**
+     * @brief Adds an element, waits while the queue is full
+     *
+     * @param value The element to be added
+     * @param size The size of the element, e.g. in bytes
+     *
+     * @return False if the queue has been closed
+     */
+    bool push(T value, std::size_t size) {
+        std::unique_lock lock(this->mutex);
+        this->notFull.wait(lock, [this] {
+            return this->closed || this->items.size() < this->capacity;
+        });
+
+        if (this->closed) {
+            return false;
+        }
+
+        this->add(std::move(value), size);
+        return true;
+    }
+
+    /**
+     * @brief Adds an element without waiting
+     *
+     * @param value The element to be added, only moved if it was added
+     * @param size The size of the element, e.g. in bytes
+     *
+     * @return False if the queue is full or has been closed
+     */
+    bool tryPush(T &value, std::size_t size) {
+        std::unique_lock lock(this->mutex);
+
+        if (this->closed || this->items.size() >= this->capacity) {
+            return false;
+        }
+
+        this->add(std::move(value), size);
+        return true;
+    }
+
+    /**
+     * @brief Takes the largest element, waits while the queue is empty
+     *
+     * @return The element or std::nullopt if the queue is closed and empty
+     */
+    std::optional<T> pop() {
+        std::unique_lock lock(this->mutex);
+        this->notEmpty.wait(lock, [this] {
+            return this->closed || !this->items.empty();
+        });
+
+        if (this->items.empty()) {
+            return std::nullopt;
+        }
+
+        std::ranges::pop_heap(this->items, Element::isSmaller);
+        std::optional<T> value(std::move(this->items.back().value));
+        this->items.pop_back();
+        this->notFull.notify_one();
+        return value;
+    }
+
+    /**
+     * @brief Closes the queue
+     * @details
+     * Wakes up all waiting threads. Elements which are already within the
+     * queue can still be taken out.
+     */
+    void close() {
+        std::unique_lock lock(this->mutex);
+        this->closed = true;
+        this->notFull.notify_all();
+        this->notEmpty.notify_all();
+    }
+
+private:
+    /**
+     * @struct Element
+     * @brief An element and what it is ordered by
+     */
+    struct Element {
+        T value; /** < The element */
+        std::size_t size; /** < Larger ones are taken first */
+        std::uint64_t order; /** < Earlier ones are taken first */
+
+        static bool isSmaller(const Element &a, const Element &b) {
+            return a.size < b.size || (a.size == b.size && a.order > b.order);
+        }
+    };
+
+    /**
+     * @brief Adds an element, the mutex has to be locked
+     */
+    void add(T value, std::size_t size) {
+        this->items.push_back(Element{std::move(value), size, this->added++});
+        std::ranges::push_heap(this->items, Element::isSmaller);
+        this->notEmpty.notify_one();
+    }
+
+    const std::size_t capacity;
+    std::vector<Element> items; /** < A heap, largest element first */
+    std::uint64_t added = 0; /** < Number of elements added so far */
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    bool closed = false;
+};
+} // namespace utilities
+
+#endif // LARGESTFIRSTQUEUE_HPP
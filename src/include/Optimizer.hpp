@@ -0,0 +1,108 @@
+/**
+ * @file Optimizer.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-22
+ * @version 0.3.0
+ * @brief Contains the Optimizer class.
+ *
+ * @see parsing::Optimizer
+ *
+ * @see src/sources/Optimizer.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef OPTIMIZER_HPP
+#define OPTIMIZER_HPP
+
+#include "FileData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace parsing {
+/**
+ * @class Optimizer
+ * @brief Removes entries of a FileData, which don't change the result
+ * @details
+ * Run on --optimize, between parsing and creating the batch file:
+ * - PATH entries are only kept at their first occurrence. Like Windows,
+ *   entries are compared ignoring the case and trailing backslashes.
+ * - Environment variables set more than once are only set to their last
+ *   value. Their names are compared ignoring the case as well.
+ *
+ * As values can't contain "%", no value can refer to another one, so the
+ * order of the variables doesn't matter.
+ *
+ * The entries are looked up in hash sets allocated from the arena of the
+ * FileData, so optimizing is linear in the number of entries.
+ */
+class Optimizer {
+public:
+    /**
+     * @struct Statistics
+     * @brief What has been removed, reported by --stats
+     */
+    struct Statistics {
+        std::uint64_t files = 0; /** < Number of files optimized */
+        std::uint64_t paths = 0; /** < Removed PATH entries */
+        std::uint64_t variables = 0; /** < Removed environment variables */
+        std::uint64_t bytes = 0; /** < Bytes saved within the batch files */
+    };
+
+    /**
+     * @brief Removes the duplicate entries of a FileData
+     * @details
+     * The saved bytes are counted for the single line layout of
+     * BatchCreator, including the separators around the values.
+     *
+     * @param data The FileData to be optimized
+     *
+     * @return What has been removed from the FileData
+     */
+    static Statistics optimize(FileData &data);
+
+    /**
+     * @brief Getter for the statistics of all files
+     * @return The summed up statistics of all optimized files
+     */
+    [[nodiscard]] static Statistics getStatistics();
+
+private:
+    /**
+     * @brief Hashes a string ignoring the case
+     */
+    struct CaseInsensitiveHash {
+        std::size_t operator()(std::string_view value) const;
+    };
+
+    /**
+     * @brief Compares two strings ignoring the case
+     */
+    struct CaseInsensitiveEqual {
+        bool operator()(std::string_view left, std::string_view right) const;
+    };
+
+    /**
+     * @brief Removes the trailing backslashes of a PATH entry
+     * @details
+     * The backslash of a root directory ("C:\") is kept, as "C:" refers to
+     * the working directory of the drive.
+     */
+    [[nodiscard]] static std::string_view normalizePath(std::string_view path);
+
+    /**
+     * @brief Removes duplicate PATH entries
+     * @return The statistics of the removed entries
+     */
+    static Statistics removeDuplicatePaths(FileData &data);
+
+    /**
+     * @brief Removes overridden environment variables
+     * @return The statistics of the removed variables
+     */
+    static Statistics removeOverriddenVariables(FileData &data);
+};
+} // namespace parsing
+
+#endif // OPTIMIZER_HPP
@@ -0,0 +1,241 @@
+/**
+ * @file ParallelChunks.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-26
+ * @version 0.3.0
+ * @brief Contains the ParallelChunks class.
+ *
+ * @see utilities::ParallelChunks
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef PARALLELCHUNKS_HPP
+#define PARALLELCHUNKS_HPP
+
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace utilities {
+/**
+ * @class ParallelChunks
+ * @brief Processes the elements of one large range on idle worker threads
+ * @details
+ * Used for configurations with a huge entries array, where converting
+ * several files at once doesn't help. The range is split into consecutive
+ * chunks of about the same size and the caller combines the results of the
+ * chunks in their order.
+ *
+ * No thread is started: the chunks are offered to the workers of the run
+ * (see setExecutor()), the calling thread processes the first chunk and
+ * every chunk no worker has started yet. So the number of threads stays at
+ * the number of jobs and the caller never waits for a worker, which is busy
+ * with something else. Without workers, everything runs on the calling
+ * thread.
+ *
+ * The result is the same as processing the range in one go:
+ * - The console output of the chunks is written in their order.
+ * - If chunks fail, the exception of the first one is thrown and the output
+ *   of the chunks after it is dropped, as they wouldn't have been reached.
+ */
+class ParallelChunks {
+public:
+    /**
+     * @brief Hands a task to an idle worker
+     * @details
+     * Returns false if the task wasn't taken, e.g. as the queue is full.
+     */
+    using Executor = std::function<bool(std::function<void()> &task)>;
+
+    /**
+     * @brief Minimum number of elements of a chunk
+     * @details
+     * Smaller ranges are processed on the calling thread, as handing them to
+     * another thread would take longer.
+     */
+    static constexpr std::size_t MIN_CHUNK_SIZE = 16384;
+
+    /**
+     * @brief Sets the workers, which process the chunks
+     * @details
+     * Has to be set before and reset after the workers run, while no range
+     * is processed.
+     *
+     * @param executor Hands a chunk to the workers, empty without workers
+     * @param threads The number of threads, which may process chunks
+     */
+    static void setExecutor(Executor executor, std::size_t threads) {
+        ParallelChunks::executor = std::move(executor);
+        ParallelChunks::threads = ParallelChunks::executor ? std::max<std::size_t>
+                                  (threads, 1) : 1;
+    }
+
+    /**
+     * @brief Number of chunks a range is split into
+     *
+     * @param size The number of elements of the range
+     *
+     * @return At least 1, at most one chunk per thread
+     */
+    [[nodiscard]] static std::size_t count(std::size_t size) {
+        return std::clamp<std::size_t>(size / MIN_CHUNK_SIZE, 1,
+                                       ParallelChunks::threads);
+    }
+
+    /**
+     * @brief Processes the chunks of a range
+     * @details
+     * The chunks after the first one are offered to the workers. The
+     * calling thread processes the first chunk, then every chunk no worker
+     * has started, and waits for the others.
+     *
+     * @param begin The first element of the range
+     * @param size The number of elements of the range
+     * @param chunks The number of chunks, see count()
+     * @param function Called as function(chunk, first, last) per chunk
+     *
+     * @throw The exception of the first chunk, which failed
+     */
+    template <typename Iterator, typename Function>
+    static void run(Iterator begin, std::size_t size, std::size_t chunks,
+                    Function function) {
+        // The boundaries are found in one pass, as the elements may not
+        // support random access
+        std::vector<Iterator> bounds{begin};
+        bounds.reserve(chunks + 1);
+
+        for (std::size_t chunk = 1; chunk <= chunks; ++chunk) {
+            bounds.push_back(std::next(bounds.back(),
+                                       static_cast<std::ptrdiff_t>(size * chunk / chunks -
+                                               size * (chunk - 1) / chunks)));
+        }
+
+        // Outlives the call, as a task may only be taken after the caller
+        // processed its chunk. The function is only called after claiming.
+        auto state = std::make_shared<State>(chunks);
+        state->process = [&function, &bounds](std::size_t chunk) {
+            function(chunk, bounds[chunk], bounds[chunk + 1]);
+        };
+
+        for (std::size_t chunk = 1; chunk < chunks && ParallelChunks::executor;
+                ++chunk) {
+            std::function<void()> task = [state, chunk] {
+                if (state->claim(chunk)) {
+                    state->runCaptured(chunk);
+                    state->finish();
+                }
+            };
+
+            if (!ParallelChunks::executor(task)) {
+                break;
+            }
+        }
+
+        state->claim(0);
+
+        try {
+            state->process(0);
+        } catch (...) {
+            state->errors[0] = std::current_exception();
+        }
+
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            if (state->claim(chunk)) {
+                state->runCaptured(chunk);
+                state->finish();
+            }
+        }
+
+        state->wait();
+
+        // The output of the first chunk has been written already
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (chunk > 0) {
+                logging::consoleOutput() << state->messages[chunk].str();
+            }
+
+            if (state->errors[chunk]) {
+                std::rethrow_exception(state->errors[chunk]);
+            }
+        }
+    }
+
+private:
+    /**
+     * @struct State
+     * @brief The chunks of a range, shared with the tasks of the workers
+     */
+    struct State {
+        explicit State(std::size_t chunks)
+            : claimed(chunks), errors(chunks), messages(chunks),
+              running(chunks) {}
+
+        /**
+         * @brief Claims a chunk, only one thread succeeds
+         */
+        bool claim(std::size_t chunk) {
+            return !this->claimed[chunk].exchange(true);
+        }
+
+        /**
+         * @brief Processes a chunk, capturing its console output
+         */
+        void runCaptured(std::size_t chunk) {
+            std::ostream *previous = logging::captureConsoleOutput(
+                                         &this->messages[chunk]);
+
+            try {
+                this->process(chunk);
+            } catch (...) {
+                this->errors[chunk] = std::current_exception();
+            }
+
+            logging::captureConsoleOutput(previous);
+        }
+
+        /**
+         * @brief Marks a chunk after the first one as processed
+         */
+        void finish() {
+            std::scoped_lock lock(this->mutex);
+
+            if (--this->running == 1) {
+                this->finished.notify_one();
+            }
+        }
+
+        /**
+         * @brief Waits for the chunks processed by the workers
+         */
+        void wait() {
+            std::unique_lock lock(this->mutex);
+            this->finished.wait(lock, [this] {
+                return this->running == 1;
+            });
+        }
+
+        std::vector<std::atomic<bool>> claimed;
+        std::vector<std::exception_ptr> errors;
+        std::vector<std::ostringstream> messages;
+        std::function<void(std::size_t)> process; /** < Set by the caller */
+        std::size_t running; /** < Chunks not processed, the first included */
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    inline static Executor executor;
+    inline static std::size_t threads = 1;
+};
+} // namespace utilities
+
+#endif // PARALLELCHUNKS_HPP
@@ -0,0 +1,133 @@
+/**
+ * @file PoolAllocator.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-14
+ * @version 0.3.0
+ * @brief Contains the PoolAllocator class.
+ *
+ * @see utilities::PoolAllocator
+ *
+ * @see src/sources/PoolAllocator.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef POOLALLOCATOR_HPP
+#define POOLALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace utilities {
+/**
+ * @class PoolAllocator
+ * @brief A slab allocator for the nodes of parsed JSON
+ * @details
+ * A Json::Value tree consists of many small map nodes, which are allocated
+ * and freed one by one. The jsoncpp library is linked as a prebuilt library,
+ * so its allocator can't be exchanged. Instead, if the application is built
+ * with JSON2BATCH_POOL_ALLOCATOR, the global operator new and delete are
+ * replaced. Only requests made within a Scope, which JsonHandler opens while
+ * parsing, are served by the pool, everything else is passed on to malloc()
+ * as it is.
+ *
+ * Requests up to MAX_SIZE bytes are rounded up to a multiple of GRANULARITY
+ * and served from slabs of SLAB_SIZE bytes, each holding blocks of one size.
+ * The slabs are taken from one reserved range of addresses, so freeing tells
+ * the blocks of the pool by their address and no header is needed.
+ *
+ * Each thread allocates from slabs of its own without a lock:
+ * - Blocks freed by the owning thread go back to their slab right away.
+ * - Blocks freed by other threads (e.g. by the writer stage) are pushed onto
+ *   a lock free list of their slab, which the owner takes over once it runs
+ *   out of blocks.
+ * - A slab without any block in use is given back to the system and reused
+ *   for any size.
+ * - When a thread ends, its slabs are taken over by the next thread running
+ *   out of blocks of the same size.
+ *
+ * So the memory of the pool is bounded by the blocks in use and doesn't grow
+ * with the number of files. The pool is only available on Unix, elsewhere
+ * all requests are passed on to malloc().
+ */
+class PoolAllocator {
+public:
+    /**
+     * @brief Largest request in bytes, which is served from the pool
+     */
+    static constexpr std::size_t MAX_SIZE = 256;
+
+    /**
+     * @brief Requests are rounded up to a multiple of this
+     */
+    static constexpr std::size_t GRANULARITY = 16;
+
+    /**
+     * @brief Size of the slabs the blocks are taken from
+     */
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+    /**
+     * @struct Statistics
+     * @brief Allocation counts of all threads, reported by --stats
+     */
+    struct Statistics {
+        std::uint64_t allocations = 0; /** < Requests within a Scope */
+        std::uint64_t pooled = 0; /** < Allocations served from the pool */
+        std::uint64_t slabs = 0; /** < Slabs taken from the system */
+        std::uint64_t released = 0; /** < Empty slabs given back */
+    };
+
+    /**
+     * @class Scope
+     * @brief Serves the requests of the thread from the pool while it exists
+     * @details
+     * Scopes may be nested. The memory may be freed outside the scope and by
+     * any thread.
+     */
+    class Scope {
+    public:
+        Scope() noexcept;
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    /**
+     * @brief Allocates memory
+     *
+     * @param size Size of the memory in bytes
+     *
+     * @return Memory aligned like by malloc() or nullptr on failure
+     */
+    [[nodiscard]] static void *allocate(std::size_t size) noexcept;
+
+    /**
+     * @brief Frees memory returned by allocate()
+     *
+     * @param pointer The memory or nullptr
+     */
+    static void deallocate(void *pointer) noexcept;
+
+    /**
+     * @brief Checks if the allocator replaces operator new
+     *
+     * @return True if built with JSON2BATCH_POOL_ALLOCATOR
+     */
+    [[nodiscard]] static bool isEnabled();
+
+    /**
+     * @brief Getter for the statistics
+     * @details
+     * Includes the counts of the calling thread and of all threads which
+     * have already ended.
+     *
+     * @return The summed up counts
+     */
+    [[nodiscard]] static Statistics getStatistics();
+
+    PoolAllocator() = delete;
+};
+} // namespace utilities
+
+#endif // POOLALLOCATOR_HPP
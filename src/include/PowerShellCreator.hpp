@@ -0,0 +1,64 @@
+/**
+ * @file PowerShellCreator.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-24
+ * @version 0.3.0
+ * @brief Contains the PowerShellCreator class.
+ *
+ * @see PowerShellCreator
+ *
+ * @see src/sources/PowerShellCreator.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef POWERSHELLCREATOR_HPP
+#define POWERSHELLCREATOR_HPP
+
+#include "FileData.hpp"
+#include "ScriptCreator.hpp"
+#include <cstddef>
+#include <memory>
+
+/**
+ * @class PowerShellCreator
+ * @brief Creates a PowerShell script (.ps1) from a FileData object
+ * @details
+ * The script behaves like the batch file:
+ * - Commands are run by cmd.exe, so batch files and arguments work the
+ *   same way. If a command fails, the script exits with its exit code
+ * - Variables and PATH are set within $env:, variables as ${env:NAME}, so
+ *   names like ProgramFiles(x86) work as well
+ * - The application is started by cmd.exe's start, like in the batch file
+ * - If the shell should stay open, a new PowerShell is started at the end
+ *
+ * Values are written within single quotes, which can't occur within
+ * values, see JsonHandler::containsBadCharacter().
+ *
+ * @see ScriptCreator
+ */
+class PowerShellCreator : public ScriptCreator<PowerShellCreator> {
+public:
+    /**
+     * @brief Creates the script
+     *
+     * @param fileData A shared pointer to the FileData object
+     */
+    explicit PowerShellCreator(std::shared_ptr<parsing::FileData> fileData);
+
+private:
+    friend class ScriptCreator<PowerShellCreator>;
+
+    /**
+     * @brief Size of the text around the value(s) of an entry
+     */
+    static constexpr std::size_t ENTRY_SIZE = 64;
+
+    void writeStart();
+    void writeCommands();
+    void writeEnvVariables();
+    void writePathVariables();
+    void writeApplication();
+    void writeEnd();
+};
+
+#endif // POWERSHELLCREATOR_HPP
@@ -0,0 +1,169 @@
+/**
+ * @file ScriptCreator.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-24
+ * @version 0.3.0
+ * @brief Contains the ScriptCreator class template and the ScriptFormat enum.
+ *
+ * @see ScriptCreator
+ *
+ * @see BatchCreator
+ * @see PowerShellCreator
+ * @see ShellCreator
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef SCRIPTCREATOR_HPP
+#define SCRIPTCREATOR_HPP
+
+#include "FileData.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @enum ScriptFormat
+ * @brief The formats of the created scripts, see --format
+ */
+enum class ScriptFormat {
+    BAT, /** < cmd.exe batch file, see BatchCreator */
+    PS1, /** < PowerShell script, see PowerShellCreator */
+    SH /** < POSIX shell script, see ShellCreator */
+};
+
+/**
+ * @brief Returns the file extension of a format
+ *
+ * @param format The format
+ *
+ * @return The extension including the dot, e.g. ".bat"
+ */
+[[nodiscard]] constexpr std::string_view getExtension(ScriptFormat format) {
+    switch (format) {
+    case ScriptFormat::PS1:
+        return ".ps1";
+
+    case ScriptFormat::SH:
+        return ".sh";
+
+    default:
+        return ".bat";
+    }
+}
+
+/**
+ * @brief Parses the name of a format
+ *
+ * @param name The name, e.g. "ps1"
+ *
+ * @return The format or std::nullopt if the name is unknown
+ */
+[[nodiscard]] constexpr std::optional<ScriptFormat> parseScriptFormat(
+    std::string_view name) {
+    if (name == "bat") {
+        return ScriptFormat::BAT;
+    }
+
+    if (name == "ps1") {
+        return ScriptFormat::PS1;
+    }
+
+    if (name == "sh") {
+        return ScriptFormat::SH;
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @class ScriptCreator
+ * @brief Base of all script creators
+ * @details
+ * Every creator writes the same parts of a FileData object in the same
+ * order, only the syntax differs. The parts are dispatched to the creator
+ * at compile time (CRTP), so writing a fragment never costs a virtual call.
+ * A creator implements:
+ * - writeStart(), writeCommands(), writeEnvVariables(),
+ *   writePathVariables(), writeApplication() and writeEnd()
+ *
+ * The content is allocated with the allocator of the FileData object.
+ *
+ * @tparam Creator The class deriving from this template
+ */
+template <typename Creator> class ScriptCreator {
+public:
+    /**
+     * @brief Moves the content out of the creator
+     *
+     * @return The content of the script
+     */
+    [[nodiscard]] std::pmr::string takeContent() {
+        return std::move(content);
+    }
+
+protected:
+    /**
+     * @brief Size of the content without any values
+     */
+    static constexpr std::size_t BASE_SIZE = 128;
+
+    /**
+     * @brief Initializes the creator, without writing anything
+     *
+     * @param fileData A shared pointer to the FileData object
+     */
+    explicit ScriptCreator(std::shared_ptr<parsing::FileData> fileData)
+        : content(fileData->get_allocator()), fileData(std::move(fileData)) {}
+
+    /**
+     * @brief Writes all parts of the script
+     *
+     * @param entrySize Size of the text around the value(s) of an entry
+     */
+    void createScript(std::size_t entrySize) {
+        this->reserve(entrySize);
+        Creator &creator = static_cast<Creator &>(*this);
+        creator.writeStart();
+        creator.writeCommands();
+        creator.writeEnvVariables();
+        creator.writePathVariables();
+        creator.writeApplication();
+        creator.writeEnd();
+    }
+
+    /**
+     * @brief Reserves the content for all values and the text around them
+     * @details
+     * That way the content is allocated once.
+     *
+     * @param entrySize Size of the text around the value(s) of an entry
+     */
+    void reserve(std::size_t entrySize) {
+        this->content.reserve(
+            BASE_SIZE + this->fileData->getValueSize() +
+            entrySize * (this->fileData->getCommands().size() +
+                         this->fileData->getEnvironmentVariables().size() +
+                         this->fileData->getPathValues().size()));
+    }
+
+    /**
+     * @brief Returns the name of the outputfile without the extension
+     * @details
+     * Used as the title of the started application.
+     */
+    [[nodiscard]] std::string_view getName() const {
+        const std::string_view outputFile = this->fileData->getOutputFile();
+        return outputFile.substr(0, outputFile.find('.'));
+    }
+
+    std::pmr::string content; /** < Content of the script */
+
+    std::shared_ptr<parsing::FileData> fileData; /** < FileData object */
+};
+
+#endif // SCRIPTCREATOR_HPP
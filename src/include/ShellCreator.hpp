@@ -0,0 +1,64 @@
+/**
+ * @file ShellCreator.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-24
+ * @version 0.3.0
+ * @brief Contains the ShellCreator class.
+ *
+ * @see ShellCreator
+ *
+ * @see src/sources/ShellCreator.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef SHELLCREATOR_HPP
+#define SHELLCREATOR_HPP
+
+#include "FileData.hpp"
+#include "ScriptCreator.hpp"
+#include <cstddef>
+#include <memory>
+
+/**
+ * @class ShellCreator
+ * @brief Creates a POSIX shell script (.sh) from a FileData object
+ * @details
+ * The script behaves like the batch file:
+ * - If a command fails, the script exits with its exit code
+ * - Variables are exported, the PATH entries are separated by ":"
+ * - Variables, whose keys aren't valid shell names, are skipped with a
+ *   warning, e.g. ProgramFiles(x86)
+ * - The application is started in the background
+ * - If the shell should stay open, $SHELL is started at the end
+ *
+ * Values are written within single quotes, which can't occur within
+ * values, see JsonHandler::containsBadCharacter().
+ *
+ * @see ScriptCreator
+ */
+class ShellCreator : public ScriptCreator<ShellCreator> {
+public:
+    /**
+     * @brief Creates the script
+     *
+     * @param fileData A shared pointer to the FileData object
+     */
+    explicit ShellCreator(std::shared_ptr<parsing::FileData> fileData);
+
+private:
+    friend class ScriptCreator<ShellCreator>;
+
+    /**
+     * @brief Size of the text around the value(s) of an entry
+     */
+    static constexpr std::size_t ENTRY_SIZE = 16;
+
+    void writeStart();
+    void writeCommands();
+    void writeEnvVariables();
+    void writePathVariables();
+    void writeApplication();
+    void writeEnd();
+};
+
+#endif // SHELLCREATOR_HPP
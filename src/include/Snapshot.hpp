@@ -0,0 +1,118 @@
+/**
+ * @file Snapshot.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-16
+ * @version 0.3.0
+ * @brief Contains the Snapshot class.
+ *
+ * @see parsing::Snapshot
+ *
+ * @see src/sources/Snapshot.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "FileData.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace parsing {
+/**
+ * @class Snapshot
+ * @brief Binary serialization of a FileData (".j2b" files)
+ * @details
+ * A snapshot stores an already parsed and validated configuration, so it
+ * can be converted again without parsing the json file.
+ *
+ * The format mirrors the layout of FileData and only consists of 32 bit
+ * values in the native byte order, followed by the characters:
+ * - The header, see Snapshot::Header
+ * - The spans of the commands, environment keys, environment values and
+ *   paths, one after the other
+ * - The blob with the characters of all values
+ *
+ * Loading a snapshot checks the header and the spans and then copies the
+ * arrays into a FileData as a whole, no value is handled on it's own.
+ * Therefore snapshots are meant for the machine they were written on, a
+ * snapshot of a machine with the other byte order is rejected by its
+ * version.
+ */
+class Snapshot {
+public:
+    /**
+     * @brief File extension of snapshots
+     */
+    static constexpr std::string_view EXTENSION = ".j2b";
+
+    /**
+     * @brief Version of the format, increased on incompatible changes
+     */
+    static constexpr std::uint32_t VERSION = 1;
+
+    /**
+     * @brief Checks if the content is a snapshot
+     *
+     * @param content The content of a file
+     *
+     * @return True if the content starts like a snapshot
+     */
+    [[nodiscard]] static bool isSnapshot(std::string_view content);
+
+    /**
+     * @brief Serializes a FileData
+     *
+     * @param data The data to be serialized
+     * @param allocator The allocator for the returned string
+     *
+     * @return The snapshot, which can be written at once
+     */
+    [[nodiscard]] static std::pmr::string
+    serialize(const FileData &data, const FileData::allocator_type &allocator);
+
+    /**
+     * @brief Loads a snapshot
+     *
+     * @param filename Name of the snapshot, used for errors
+     * @param content The content of the snapshot
+     * @param resource Memory resource for the FileData
+     *
+     * @return The loaded FileData
+     *
+     * @throw exceptions::InvalidSnapshotException
+     */
+    [[nodiscard]] static std::shared_ptr<FileData>
+    load(const std::string &filename, std::string_view content,
+         std::pmr::memory_resource *resource);
+
+    Snapshot() = delete;
+
+private:
+    /**
+     * @struct Header
+     * @brief The start of every snapshot
+     */
+    struct Header {
+        char magic[4]; /** < Always "J2B\0" */
+        std::uint32_t version; /** < Snapshot::VERSION */
+        std::uint32_t flags; /** < See HIDE_SHELL and HAS_APPLICATION */
+        Span outputfile; /** < Span of the outputfile */
+        Span application; /** < Span of the application, if given */
+        std::uint32_t commandCount; /** < Number of commands */
+        std::uint32_t environmentCount; /** < Number of variables */
+        std::uint32_t pathCount; /** < Number of paths */
+        std::uint32_t blobSize; /** < Number of characters */
+    };
+
+    static constexpr char MAGIC[4] = {'J', '2', 'B', '\0'};
+    static constexpr std::uint32_t HIDE_SHELL = 1;
+    static constexpr std::uint32_t HAS_APPLICATION = 2;
+};
+} // namespace parsing
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,104 @@
+/**
+ * @file TarWriter.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-18
+ * @version 0.3.0
+ * @brief Contains the TarWriter class.
+ *
+ * @see utilities::TarWriter
+ *
+ * @see src/sources/TarWriter.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef TARWRITER_HPP
+#define TARWRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace utilities {
+/**
+ * @class TarWriter
+ * @brief Streams files into a tar archive (ustar format)
+ * @details
+ * Every file is appended as soon as it is added, through a single buffered
+ * stream. That way a large run only writes one file with a few large
+ * writes, instead of creating, writing and closing every batch file.
+ *
+ * The archive only depends on the added files and their order:
+ * - All entries have the same modification time, which is taken from the
+ *   environment variable SOURCE_DATE_EPOCH or 0 if it isn't set
+ * - User and group are always 0 and unnamed, the mode is always 0644
+ */
+class TarWriter {
+public:
+    /**
+     * @brief Size of the blocks of a tar archive
+     */
+    static constexpr std::size_t BLOCK_SIZE = 512;
+
+    /**
+     * @brief Size of the buffer of the archive
+     */
+    static constexpr std::size_t BUFFER_SIZE = 1024 * 1024;
+
+    /**
+     * @brief Creates the archive, an existing file is overwritten
+     *
+     * @param filename The path of the archive
+     *
+     * @throw exceptions::FailedToOpenFileException
+     */
+    explicit TarWriter(std::string filename);
+
+    TarWriter(const TarWriter &) = delete;
+    TarWriter &operator=(const TarWriter &) = delete;
+
+    /**
+     * @brief Appends a file to the archive
+     * @details
+     * A leading '/' is removed from the name, like tar does. Names longer
+     * than 100 characters are split into the prefix and the name of the
+     * header at a '/'.
+     *
+     * @param name The path of the file within the archive
+     * @param content The content of the file
+     *
+     * @throw exceptions::ArchiveException If the name or the content don't
+     * fit into the header or writing failed
+     */
+    void add(std::string_view name, std::string_view content);
+
+    /**
+     * @brief Writes the end of the archive and flushes it
+     *
+     * @throw exceptions::ArchiveException If writing failed
+     */
+    void finish();
+
+private:
+    /**
+     * @brief Writes a number as a zero padded octal field
+     *
+     * @return False if the number doesn't fit into the field
+     */
+    static bool writeOctal(char *field, std::size_t size, std::uint64_t value);
+
+    /**
+     * @brief Reads the modification time of all entries
+     */
+    static std::uint64_t readModificationTime();
+
+    const std::string filename;
+    std::unique_ptr<char[]> buffer;
+    std::ofstream file;
+    const std::uint64_t modificationTime;
+};
+} // namespace utilities
+
+#endif // TARWRITER_HPP
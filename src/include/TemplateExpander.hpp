@@ -0,0 +1,179 @@
+/**
+ * @file TemplateExpander.hpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-25
+ * @version 0.3.0
+ * @brief Contains the TemplateExpander class.
+ *
+ * @see parsing::TemplateExpander
+ *
+ * @see src/sources/TemplateExpander.cpp
+ *
+ * @copyright See LICENSE file
+ */
+#ifndef TEMPLATEEXPANDER_HPP
+#define TEMPLATEEXPANDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parsing {
+/**
+ * @class TemplateExpander
+ * @brief Replaces "${NAME}" placeholders by the values defined for the run
+ * @details
+ * The values are defined by -D NAME=VALUE and by --defines files before
+ * any file is converted and may refer to other defines. resolve() expands
+ * the defines once, so a define referring to itself (directly or through
+ * other defines) is reported before converting anything.
+ *
+ * The values of commands, paths, variables and applications are expanded
+ * by JsonHandler. Each distinct value containing a placeholder is expanded
+ * once per run, later occurrences are looked up in a memo table shared by
+ * all threads. Values without a placeholder are returned as they are.
+ *
+ * A name consists of letters, digits and underscores and doesn't start with
+ * a digit, other text like "${env:Path}" is kept. "$${" is kept as "${".
+ *
+ * This class is singleton, like KeyValidator.
+ */
+class TemplateExpander {
+public:
+    /**
+     * @struct Statistics
+     * @brief Expanded values, reported by --stats
+     */
+    struct Statistics {
+        std::uint64_t templates = 0; /** < Distinct values expanded */
+        std::uint64_t reused = 0; /** < Values taken from the memo table */
+    };
+
+    /**
+     * @brief Get the instance of this class
+     *
+     * @return Reference to the instance of this class
+     */
+    static TemplateExpander &getInstance();
+
+    /**
+     * @brief Defines a value, replacing an earlier one of the same name
+     *
+     * @param definition The definition, e.g. "ROOT=C:\tools"
+     * @param source Where the definition is from, used for errors
+     *
+     * @throw exceptions::InvalidValueException If the name is invalid
+     */
+    void define(std::string_view definition, const std::string &source = "-D");
+
+    /**
+     * @brief Defines the values listed in a file
+     * @details
+     * One NAME=VALUE definition per line, empty lines and lines starting
+     * with "#" are skipped.
+     *
+     * @param path The path of the file
+     *
+     * @throw exceptions::FailedToOpenFileException
+     * @throw exceptions::InvalidValueException If a name is invalid
+     */
+    void loadDefines(const std::string &path);
+
+    /**
+     * @brief Expands the defines, which refer to other defines
+     * @details
+     * Has to be called after the last define and before the first value is
+     * expanded.
+     *
+     * @throw exceptions::InvalidValueException If a define refers to itself
+     * or to a name which isn't defined
+     */
+    void resolve();
+
+    /**
+     * @brief Expands the placeholders of a value
+     *
+     * @param key The key of the value, used for errors
+     * @param value The value
+     *
+     * @return The expanded value, valid until the end of the run
+     *
+     * @throw exceptions::InvalidValueException If a name isn't defined
+     */
+    [[nodiscard]] std::string_view expand(std::string_view key,
+                                          std::string_view value);
+
+    /**
+     * @brief Getter for the statistics of the run
+     */
+    [[nodiscard]] Statistics getStatistics() const;
+
+private:
+    /**
+     * @brief Hashes strings and string views alike
+     * @details
+     * Lets the memo table be searched without copying the value.
+     */
+    struct Hash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view> {}(value);
+        }
+    };
+
+    /**
+     * @brief Looks up the value of a name, see substitute()
+     */
+    using Lookup = std::function<const std::string &(std::string_view)>;
+
+    TemplateExpander() = default;
+
+    /**
+     * @brief Checks whether a name may be used within a placeholder
+     */
+    [[nodiscard]] static bool isName(std::string_view name);
+
+    /**
+     * @brief Replaces the placeholders of a value
+     *
+     * @param value The value
+     * @param lookup Returns the value of a name or throws
+     *
+     * @return The expanded value
+     */
+    [[nodiscard]] static std::string substitute(std::string_view value,
+            const Lookup &lookup);
+
+    /**
+     * @brief Expands a define, see resolve()
+     *
+     * @param name The name of the define
+     * @param resolving The defines currently being expanded
+     *
+     * @return The expanded value
+     */
+    const std::string &resolveDefine(std::string_view name,
+                                     std::vector<std::string_view> &resolving);
+
+    // The defines, expanded by resolve()
+    std::unordered_map<std::string, std::string, Hash, std::equal_to<>>
+            defines;
+    std::unordered_map<std::string, std::string, Hash, std::equal_to<>>
+            resolved;
+
+    // Expanded values by their template, the nodes never move, so the
+    // returned views stay valid while the table grows
+    std::unordered_map<std::string, std::string, Hash, std::equal_to<>> memo;
+    mutable std::shared_mutex memoMutex; /** < Guards memo */
+    std::atomic<std::uint64_t> reused{0};
+};
+} // namespace parsing
+
+#endif // TEMPLATEEXPANDER_HPP
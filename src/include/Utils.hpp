@@ -20,6 +20,7 @@
 
 #include "Exceptions.hpp"
 #include <string>
+#include <string_view>
 
 /**
  * @namespace utilities
@@ -56,22 +57,23 @@ public:
      * This function handles an exception within the main parsing loop. It
      * displays the error message and asks the user if they want to continue.
      * - Moved to Utils in 0.2.2 to improve readibility in main.cpp
+     * - Takes a name instead of the list of files since 0.3.0, as a file
+     *   may contain multiple configurations
      *
      * @param e The exception to be handled
-     * @param file The file which caused the exception
-     * @param files The list of files
+     * @param name The file or configuration which caused the exception
+     * @param hasMore True if there are more files to be handled
      *
      * @return Returns true if the user wants to continue and false otherwise
      */
-    static bool
-    handleParseException(const std::exception &e,
-                         const std::vector<std::string>::iterator &file,
-                         const std::vector<std::string> &files);
+    static bool handleParseException(const std::exception &e,
+                                     const std::string &name, bool hasMore);
 
     /**
      * @brief Asks if the user wants to continue
      * @details
      * Asks the user if they want to continue and prompts them for a response.
+     * If the application isn't interactive, the prompt is answered with yes.
      * @param prompt (Optional) A custom prompt to be used.
      * @return Returns true if the user wants to continue and false otherwise.
      */
@@ -107,7 +109,22 @@ public:
     *
     * @return The processed string
     */
-    static std::string escapeString(const std::string &str);
+    static std::string escapeString(std::string_view str);
+
+    /**
+     * @brief Sets whether the user can be asked
+     * @details
+     * The user can't be asked, if the standard input is used for the
+     * configurations. Added in 0.3.0.
+     *
+     * @param newInteractive False to answer all prompts with yes
+     */
+    static void setInteractive(bool newInteractive) {
+        interactive = newInteractive;
+    }
+
+private:
+    static inline bool interactive = true;
 };
 } // namespace utilities
 
@@ -27,16 +27,29 @@
  * @copyright See LICENSE file
  */
 #include <LoggingWrapper.hpp>
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <filesystem>
-#include <fstream>
-#include <tuple>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <thread>
 #include <vector>
 
-#include "BatchCreator.hpp"
+#include "Arena.hpp"
 #include "CommandLineHandler.hpp"
+#include "ConversionPipeline.hpp"
+#include "DirectoryWalker.hpp"
 #include "Exceptions.hpp"
-#include "JsonHandler.hpp"
+#include "FileList.hpp"
+#include "FileSystemCache.hpp"
+#include "InternTable.hpp"
+#include "IoUring.hpp"
+#include "Optimizer.hpp"
+#include "PoolAllocator.hpp"
+#include "Snapshot.hpp"
+#include "TemplateExpander.hpp"
 #include "Utils.hpp"
 #include "config.hpp"
 
@@ -45,29 +58,46 @@
  *
  * @param argc Number of arguments provided
  * @param argv The arguments provided
- * @return A tuple containing the files to be parsed and the output directory
+ * @return The parsed arguments with a checked output directory
  */
-std::tuple<std::vector<std::string>, std::string>
-parseAndValidateArgs(int argc, char *argv[]);
+cli::Arguments parseAndValidateArgs(int argc, char *argv[]);
 
 /**
  * @brief Checks if the files are valid
  * @details
  * Makes sures, that provided files exists and checks their file ending
+ * Directories are replaced by the files found within them (since 0.3.0).
+ * With largestFirst the valid files are sorted by their size, so the
+ * workers start the largest file first (since 0.3.0).
  * @param files The files to be checked
+ * @param ioUring If given, the files are checked in one batch
+ * @param walker Searches the directories
+ * @param largestFirst Sort the files by size, largest first
+ * @param validFiles Receives the valid files
  * - {ReqFunc5}
- *
- * @return A vector containing the valid files
  */
-std::vector<std::string> validateFiles(const std::vector<std::string> &files);
+void validateFiles(const std::vector<std::string> &files,
+                   std::optional<utilities::IoUring> &ioUring,
+                   const utilities::DirectoryWalker &walker, bool largestFirst,
+                   utilities::FileList &validFiles);
 
 /**
- * @brief Parses the given file and writes the output to the output directory
+ * @brief Sorts files by their size, largest first
  * @details
- * Creates the Batch file from the given file
- * @param file The file to be parsed
+ * Files of the same size keep their order. The sizes are read in one batch
+ * with io_uring, if it's available.
+ * - Added in 0.3.0
+ *
+ * @param files The files to be sorted
+ * @param ioUring If given, the files are checked in one batch
+ */
+void sortLargestFirst(std::vector<utilities::WalkedFile> &files,
+                      std::optional<utilities::IoUring> &ioUring);
+
+/**
+ * @brief Prints the statistics requested by --stats
  */
-void parseFile(const std::string &file, const std::string &outputDirectory);
+void printStatistics();
 
 /**
  * @brief Main function of the program
@@ -87,83 +117,233 @@ int main(int argc, char *argv[]) {
     utilities::Utils::checkConfigFile(config::LOG_CONFIG);
     utilities::Utils::setupEasyLogging(config::LOG_CONFIG);
     // Parse and validate arguments
-    auto [files, outDir] = parseAndValidateArgs(argc, argv);
+    cli::Arguments arguments = parseAndValidateArgs(argc, argv);
+
+    // The standard output only contains the batch files
+    if (arguments.toStdout) {
+        logging::redirectConsoleOutput(&std::cerr);
+    }
+
+    // The defines apply to every file, a broken one stops the run
+    try {
+        auto &templateExpander = parsing::TemplateExpander::getInstance();
+
+        // The files are read first, -D overrides their values
+        for (const auto &file : arguments.definesFiles) {
+            templateExpander.loadDefines(file);
+        }
+
+        for (const auto &define : arguments.defines) {
+            templateExpander.define(define);
+        }
+
+        templateExpander.resolve();
+    } catch (const exceptions::CustomException &e) {
+        LOG_ERROR << e.what();
+        exit(1);
+    }
+
+    const std::string outDir = arguments.outDir.value_or("");
     OUTPUT << cli::BOLD << "Parsing the following files:\n" << cli::RESET;
 
-    for (const auto &file : files) {
+    for (const auto &file : arguments.files) {
         OUTPUT << "\t - " << file << "\n";
     }
 
-    files = validateFiles(files);
+    for (const auto &list : arguments.fileLists) {
+        OUTPUT << "\t - The files listed in " << list << "\n";
+    }
 
-    // Loop for {ReqFunc7}
-    for (auto file = files.begin(); file != files.end(); ++file) {
-        OUTPUT << cli::ITALIC << "\nParsing file: " << *file << "...\n"
-               << cli::RESET;
+    // io_uring only pays off, if there is more than one file
+    std::optional<utilities::IoUring> ioUring;
 
-        try {
-            parseFile(*file, outDir);
-            // Only catch custom exceptions, other exceptions are fatal
-        } catch (const exceptions::CustomException &e) {
-            LOG_INFO << "Caught custom exception: " << typeid(e).name();
-            if (utilities::Utils::handleParseException(e, file, files)) {
-                continue;
-            }
+    if (arguments.ioUring &&
+            (arguments.files.size() > 1 || !arguments.fileLists.empty()) &&
+            utilities::IoUring::isAvailable()) {
+        LOG_INFO << "Using io_uring for file I/O";
+        ioUring.emplace();
+    }
 
-            exit(1);
-        } catch (const Json::Exception &e) {
-            LOG_INFO << "Caught Json exception: " << typeid(e).name();
-            if (utilities::Utils::handleParseException(e, file, files)) {
-                continue;
+    const utilities::DirectoryWalker walker({
+        arguments.includes, arguments.excludes, arguments.ignoreFile
+    });
+    utilities::FileList files;
+    // Only a list known up front can be sorted, a single job converts the
+    // files in the given order anyway. The standard output and the archive
+    // keep the given order.
+    const bool largestFirst = arguments.jobs != 1 && arguments.fileLists.empty() &&
+                              !arguments.toStdout && !arguments.archive &&
+                              std::ranges::find(arguments.files,
+                                      parsing::ConversionPipeline::STANDARD_INPUT) == arguments.files.end();
+    validateFiles(arguments.files, ioUring, walker, largestFirst, files);
+    // The lists are read while the files are already converted, missing
+    // files are reported when they are read
+    std::thread listReader;
+
+    if (arguments.fileLists.empty()) {
+        files.close();
+    } else {
+        listReader = std::thread([&files, &arguments] {
+            for (const auto &list : arguments.fileLists) {
+                try {
+                    files.addFromList(list);
+                } catch (const exceptions::CustomException &e) {
+                    LOG_ERROR << e.what();
+                }
             }
 
-            exit(1);
-        }
+            files.close();
+        });
+    }
+
+    // Errors of the archive can't be skipped like the errors of a file
+    try {
+        // Loop for {ReqFunc7}
+        parsing::ConversionPipeline pipeline(files, {
+            outDir, ioUring.has_value(), arguments.emitSnapshot, arguments.jobs,
+            arguments.toStdout, arguments.archive.value_or(""), arguments.layout,
+            arguments.optimize, arguments.formats
+        });
+        pipeline.run();
+    } catch (const exceptions::CustomException &e) {
+        LOG_ERROR << e.what();
+        exit(1);
+    }
 
+    if (listReader.joinable()) {
+        listReader.join();
     }
+
     OUTPUT << "Done parsing files!\n";
 
+    if (arguments.stats) {
+        printStatistics();
+    }
+
     LOG_INFO << "Exiting...";
     return 0;
 }
 
-std::tuple<std::vector<std::string>, std::string>
-parseAndValidateArgs(int argc, char *argv[]) {
+cli::Arguments parseAndValidateArgs(int argc, char *argv[]) {
     if (argc < 2) {
         LOG_ERROR << "No options given!";
         cli::CommandLineHandler::printHelp();
     }
 
-    auto [outOption, files] = cli::CommandLineHandler::parseArguments(argc, argv);
+    cli::Arguments arguments = cli::CommandLineHandler::parseArguments(argc, argv);
     // Set the output directory if given
-    std::string outDir = outOption.value_or("");
+    std::string outDir = arguments.outDir.value_or("");
 
     if (!outDir.empty()) {
         try {
-            outDir = utilities::Utils::checkDirectory(outDir);
+            arguments.outDir = utilities::Utils::checkDirectory(outDir);
         } catch (const exceptions::CustomException &e) {
             LOG_ERROR << e.what();
             exit(1);
         }
     }
 
-    if (files.empty()) {
+    if (arguments.files.empty() && arguments.fileLists.empty()) {
         LOG_ERROR << "No files were given as arguments!";
         exit(1);
     }
 
-    return {files, outDir};
+    const bool readsConfigurations = std::ranges::find(arguments.files,
+                                     parsing::ConversionPipeline::STANDARD_INPUT) != arguments.files.end();
+    const bool readsList = std::ranges::find(arguments.fileLists,
+                           parsing::ConversionPipeline::STANDARD_INPUT) != arguments.fileLists.end();
+
+    if (readsConfigurations && readsList) {
+        LOG_ERROR << "The standard input can't contain both configurations "
+                  "and a list of files!";
+        exit(1);
+    }
+
+    // Lists are read while converting, so they have to exist beforehand
+    for (const auto &list : arguments.fileLists) {
+        if (list != parsing::ConversionPipeline::STANDARD_INPUT &&
+                !std::filesystem::is_regular_file(list)) {
+            LOG_ERROR << "The list of files \"" << list << "\" does not exist!";
+            exit(1);
+        }
+    }
+
+    // The standard input contains the configurations, not the answers
+    if (readsConfigurations || readsList) {
+        LOG_INFO << "Reading from stdin, prompts are answered with yes";
+        utilities::Utils::setInteractive(false);
+    }
+
+    // No files are written with --stdout, snapshots included
+    if (arguments.toStdout && arguments.emitSnapshot) {
+        LOG_ERROR << "--stdout can't be combined with --emit-snapshot!";
+        exit(1);
+    }
+
+    if (arguments.toStdout && arguments.formats.size() > 1) {
+        LOG_ERROR << "--stdout can't be combined with more than one format!";
+        exit(1);
+    }
+
+    if (arguments.archive) {
+        if (arguments.toStdout) {
+            LOG_ERROR << "--stdout can't be combined with --archive!";
+            exit(1);
+        }
+
+        if (std::filesystem::exists(*arguments.archive) &&
+                !utilities::Utils::askToContinue(
+                    "The archive already exists, do you want to overwrite it? "
+                    "(y/n) ")) {
+            OUTPUT << "Aborting...\n";
+            LOG_INFO << "Application ended by user Input";
+            exit(1);
+        }
+    }
+
+    // 0 uses all cores, hardware_concurrency() may not know them either
+    if (arguments.jobs == 0) {
+        arguments.jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    return arguments;
 }
 
-std::vector<std::string> validateFiles(const std::vector<std::string> &files) {
-    std::vector<std::string> validFiles;
-    // Reserve space, to avaid reallocating with each valid file
-    validFiles.reserve(files.size());
+void validateFiles(const std::vector<std::string> &files,
+                   std::optional<utilities::IoUring> &ioUring,
+                   const utilities::DirectoryWalker &walker, bool largestFirst,
+                   utilities::FileList &validFiles) {
+    // With io_uring all files are checked at once
+    std::vector<utilities::FileStatus> statuses;
+    std::vector<utilities::WalkedFile> found;
+
+    if (ioUring) {
+        statuses = ioUring->statFiles(files);
+    }
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const std::filesystem::path file = files[i];
+
+        // The standard input is read by the pipeline
+        if (files[i] == parsing::ConversionPipeline::STANDARD_INPUT) {
+            found.push_back({files[i], ""});
+            continue;
+        }
+
+        // A single stat tells files and directories apart
+        const utilities::FileStatus status = ioUring ? statuses[i]
+                                             : utilities::FileSystemCache::stat(files[i]);
 
-    for (const std::filesystem::path file : files) {
         // Check that the file exists
         // {ReqFunc5}
-        if (!std::filesystem::is_regular_file(file)) {
+        if (!status.isRegularFile) {
+            // The files within directories are already filtered
+            if (status.isDirectory) {
+                std::ranges::move(walker.walk(files[i]), std::back_inserter(found));
+
+                continue;
+            }
+
             LOG_ERROR << "The file \"" << file << "\" does not exist!";
 
             if (files.size() > 1 && !utilities::Utils::askToContinue()) {
@@ -175,8 +355,9 @@ std::vector<std::string> validateFiles(const std::vector<std::string> &files) {
             continue;
         }
 
-        // Check if the file ends in .json
-        if (file.extension() != ".json") {
+        // Check if the file ends in .json, snapshots are checked on loading
+        if (file.extension() != ".json" && file.extension() != ".jsonl" &&
+                file.extension() != parsing::Snapshot::EXTENSION) {
             LOG_WARNING << "The file \"" << file << R"(" does not end in ".json")";
             OUTPUT << "If the file is not in JSON Format, continuing may "
                    "result in\nunexpected behaviour!\n";
@@ -188,41 +369,134 @@ std::vector<std::string> validateFiles(const std::vector<std::string> &files) {
             }
         }
 
-        validFiles.push_back(file.string());
+        found.push_back({file.string(), ""});
     }
 
-    // Shrinks the vector if invalid files were found
-    validFiles.shrink_to_fit();
-    return validFiles;
+    if (largestFirst && found.size() > 1) {
+        sortLargestFirst(found, ioUring);
+    }
+
+    for (auto &file : found) {
+        validFiles.add(std::move(file.path), std::move(file.subdirectory));
+    }
 }
 
-void parseFile(const std::string &file, const std::string &outputDirectory) {
-    parsing::JsonHandler jsonHandler(file);
-    const auto fileData = jsonHandler.getFileData();
-    BatchCreator batchCreator(fileData);
-    const std::shared_ptr<std::stringstream> dataStream =
-        batchCreator.getDataStream();
-    // Full filename is output directory + output file
-    // {ReqFunc18}
-    const std::string outputFileName =
-        outputDirectory + fileData->getOutputFile();
-
-    if (std::filesystem::is_regular_file(outputFileName)) {
-        if (!utilities::Utils::askToContinue(
-                    "The file already exists, do you want to overwrite it? (y/n) ")) {
-            OUTPUT << "Skipping file...\n";
-            return;
+void sortLargestFirst(std::vector<utilities::WalkedFile> &files,
+                      std::optional<utilities::IoUring> &ioUring) {
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+
+    for (const auto &file : files) {
+        paths.push_back(file.path);
+    }
+
+    std::vector<utilities::FileStatus> statuses;
+
+    if (ioUring) {
+        statuses = ioUring->statFiles(paths);
+    } else {
+        statuses.reserve(paths.size());
+
+        for (const auto &path : paths) {
+            statuses.push_back(utilities::FileSystemCache::stat(path));
         }
-        OUTPUT << "Overwriting file...\n";
     }
 
-    std::ofstream outFile(outputFileName);
+    // Files of the same size keep their order
+    std::vector<std::size_t> order(files.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, [&statuses](std::size_t a, std::size_t b) {
+        return statuses[a].size > statuses[b].size;
+    });
+    std::vector<utilities::WalkedFile> sorted;
+    sorted.reserve(files.size());
+
+    for (const std::size_t i : order) {
+        sorted.push_back(std::move(files[i]));
+    }
+
+    files = std::move(sorted);
+}
 
-    if (!outFile.good()) {
-        throw exceptions::FailedToOpenFileException(outputFileName);
+void printStatistics() {
+    const auto arenas = utilities::Arena::getStatistics();
+    OUTPUT << cli::BOLD << "\nStatistics:\n" << cli::RESET
+           << "\t - Files handled: " << arenas.resets << "\n"
+           << "\t - Arenas created: " << arenas.arenas << "\n"
+           << "\t - Arena allocations: " << arenas.allocations << " ("
+           << arenas.bytes << " bytes)\n"
+           << "\t - Heap allocations by arenas: " << arenas.heapAllocations
+           << " (" << arenas.heapBytes << " bytes)\n";
+
+    if (const auto optimized = parsing::Optimizer::getStatistics();
+            optimized.files > 0) {
+        OUTPUT << "\t - Duplicate entries removed: " << optimized.paths
+               << " PATH entries, " << optimized.variables << " variables ("
+               << optimized.bytes << " bytes)\n";
     }
 
-    outFile << dataStream->str();
+    if (const auto interned = parsing::InternTable::getInstance()
+                              .getStatistics();
+            interned.values > 0) {
+        OUTPUT << "\t - Values interned: " << interned.values << " ("
+               << interned.bytes << " bytes), " << interned.reused
+               << " reused\n";
+    }
+
+    if (const auto templates = parsing::TemplateExpander::getInstance()
+                               .getStatistics();
+            templates.templates > 0) {
+        OUTPUT << "\t - Templates expanded: " << templates.templates
+               << " distinct values (" << templates.reused << " reused)\n";
+    }
+
+    const auto toMilliseconds = [](std::chrono::nanoseconds duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration)
+               .count();
+    };
+
+    if (const auto workers = parsing::ConversionPipeline::getWorkerStatistics();
+            !workers.empty()) {
+        std::chrono::nanoseconds longest{0};
+        std::optional<std::chrono::steady_clock::time_point> firstFinished;
+        std::optional<std::chrono::steady_clock::time_point> lastFinished;
+
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            const auto &worker = workers[i];
+            const auto alive = std::max<std::chrono::nanoseconds>(worker.alive,
+                               std::chrono::nanoseconds(1));
+            OUTPUT << "\t - Worker " << i + 1 << ": " << worker.configurations
+                   << " configurations, " << worker.chunks << " chunks, busy "
+                   << toMilliseconds(worker.busy) << " of "
+                   << toMilliseconds(worker.alive) << " ms ("
+                   << worker.busy * 100 / alive << "%)\n";
+
+            // Workers without a configuration didn't take part in the tail
+            if (worker.configurations > 0) {
+                longest = std::max(longest, worker.longest);
+                firstFinished = std::min(firstFinished.value_or(worker.finished),
+                                         worker.finished);
+                lastFinished = std::max(lastFinished.value_or(worker.finished),
+                                        worker.finished);
+            }
+        }
+
+        if (firstFinished) {
+            OUTPUT << "\t - Workers finished within "
+                   << toMilliseconds(*lastFinished - *firstFinished)
+                   << " ms of each other, the longest configuration took "
+                   << toMilliseconds(longest) << " ms\n";
+        }
+    }
+
+    if (utilities::PoolAllocator::isEnabled()) {
+        const auto pool = utilities::PoolAllocator::getStatistics();
+        OUTPUT << "\t - Allocations while parsing: " << pool.allocations << " ("
+               << pool.pooled << " from the pool)\n"
+               << "\t - Pool slabs: " << pool.slabs << " ("
+               << pool.slabs * utilities::PoolAllocator::SLAB_SIZE << " bytes), "
+               << pool.released << " released when empty\n";
+    }
 }
 
 // Initialize easylogging++
@@ -0,0 +1,103 @@
+/**
+ * @file Arena.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-13
+ * @version 0.3.0
+ * @brief Implementation of the Arena and ArenaPool classes.
+ *
+ * @see src/include/Arena.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "Arena.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace utilities {
+namespace {
+// Summed up counts of all arenas
+std::mutex statisticsMutex;
+Arena::Statistics statistics;
+} // namespace
+
+void *Arena::CountingResource::do_allocate(std::size_t size,
+        std::size_t alignment) {
+    ++this->allocations;
+    this->bytes += size;
+    return this->upstream->allocate(size, alignment);
+}
+
+void Arena::CountingResource::do_deallocate(void *pointer, std::size_t size,
+        std::size_t alignment) {
+    this->upstream->deallocate(pointer, size, alignment);
+}
+
+Arena::Arena() : buffer(new std::byte[INITIAL_SIZE]) {
+    this->monotonic.emplace(this->buffer.get(), this->bufferSize, &this->heap);
+    this->counter.upstream = &*this->monotonic;
+    std::scoped_lock lock(statisticsMutex);
+    ++statistics.arenas;
+}
+
+void Arena::reset() {
+    const std::uint64_t heapBytes = this->heap.bytes;
+
+    {
+        std::scoped_lock lock(statisticsMutex);
+        ++statistics.resets;
+        statistics.allocations += this->counter.allocations;
+        statistics.bytes += this->counter.bytes;
+        statistics.heapAllocations += this->heap.allocations;
+        statistics.heapBytes += heapBytes;
+    }
+
+    this->counter.allocations = 0;
+    this->counter.bytes = 0;
+    this->heap.allocations = 0;
+    this->heap.bytes = 0;
+
+    // The buffer is kept, unless the file didn't fit into it
+    if (heapBytes == 0 || this->bufferSize >= MAX_SIZE) {
+        this->monotonic->release();
+        return;
+    }
+
+    this->bufferSize = std::min(MAX_SIZE,
+                                std::bit_ceil(this->bufferSize + heapBytes));
+    LOG_INFO << "Enlarging arena to " << this->bufferSize << " bytes";
+    this->monotonic.reset();
+    this->buffer.reset(new std::byte[this->bufferSize]);
+    this->monotonic.emplace(this->buffer.get(), this->bufferSize, &this->heap);
+    this->counter.upstream = &*this->monotonic;
+}
+
+Arena::Statistics Arena::getStatistics() {
+    std::scoped_lock lock(statisticsMutex);
+    return statistics;
+}
+
+std::unique_ptr<Arena> ArenaPool::acquire() {
+    {
+        std::scoped_lock lock(this->mutex);
+
+        if (!this->arenas.empty()) {
+            auto arena = std::move(this->arenas.back());
+            this->arenas.pop_back();
+            return arena;
+        }
+    }
+
+    LOG_INFO << "Creating new arena";
+    return std::make_unique<Arena>();
+}
+
+void ArenaPool::release(std::unique_ptr<Arena> arena) {
+    arena->reset();
+    std::scoped_lock lock(this->mutex);
+    this->arenas.push_back(std::move(arena));
+}
+} // namespace utilities
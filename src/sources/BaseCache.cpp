@@ -0,0 +1,94 @@
+/**
+ * @file BaseCache.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-23
+ * @version 0.3.0
+ * @brief Implementation of the BaseCache class.
+ *
+ * @see src/include/BaseCache.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "BaseCache.hpp"
+#include "Exceptions.hpp"
+#include "InputFile.hpp"
+#include "JsonHandler.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace parsing {
+BaseCache &BaseCache::getInstance() {
+    static BaseCache baseCache;
+    return baseCache;
+}
+
+std::shared_ptr<const FileData> BaseCache::get(const std::string &path) {
+    if (const Entry *entry = this->find(path)) {
+        return take(*entry);
+    }
+
+    const std::lock_guard loadingLock(this->loadingMutex);
+
+    // Another thread may have loaded it in the meantime
+    if (const Entry *entry = this->find(path)) {
+        return take(*entry);
+    }
+
+    if (std::ranges::find(this->loading, path) != this->loading.end()) {
+        throw exceptions::InvalidValueException(
+            "extends", "The base \"" + path + "\" extends itself!");
+    }
+
+    LOG_INFO << "Loading base configuration " << path;
+    this->loading.push_back(path);
+    Entry entry;
+
+    // The base is allocated from the heap, as it outlives every arena
+    try {
+        const utilities::InputFile input(path);
+        JsonHandler jsonHandler(path, input);
+        entry.data = jsonHandler.getBaseFileData();
+    } catch (...) {
+        entry.error = std::current_exception();
+    }
+
+    this->loading.pop_back();
+    const std::lock_guard lock(this->mutex);
+    return take(this->entries.emplace(path, std::move(entry)).first->second);
+}
+
+std::string BaseCache::resolve(std::string_view extending,
+                               std::string_view base) {
+    std::filesystem::path path(base);
+
+    // Names of configurations within a file only add a suffix to the file
+    if (const std::size_t separator = extending.find_last_of("/\\");
+            path.is_relative() && separator != std::string_view::npos) {
+        path = std::filesystem::path(extending.substr(0, separator + 1)) / path;
+    }
+
+    return path.lexically_normal().string();
+}
+
+std::size_t BaseCache::size() {
+    const std::lock_guard lock(this->mutex);
+    return this->entries.size();
+}
+
+const BaseCache::Entry *BaseCache::find(const std::string &path) {
+    const std::lock_guard lock(this->mutex);
+    const auto entry = this->entries.find(path);
+    return entry == this->entries.end() ? nullptr : &entry->second;
+}
+
+std::shared_ptr<const FileData> BaseCache::take(const Entry &entry) {
+    if (entry.error) {
+        std::rethrow_exception(entry.error);
+    }
+
+    return entry.data;
+}
+} // namespace parsing
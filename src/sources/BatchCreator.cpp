@@ -12,85 +12,226 @@
 
 #include "BatchCreator.hpp"
 #include "LoggingWrapper.hpp"
+#include <string_view>
 #include <utility>
+#include <vector>
 
-BatchCreator::BatchCreator(std::shared_ptr<parsing::FileData> fileData)
-    : fileData(std::move(fileData)) {
+BatchCreator::BatchCreator(std::shared_ptr<parsing::FileData> fileData,
+                           Layout layout)
+    : ScriptCreator(std::move(fileData)), layout(layout) {
   LOG_INFO << "Initializing BatchCreator";
-  this->dataStream = std::make_shared<std::stringstream>();
   this->createBatch();
 }
 
-void BatchCreator::createBatch() const {
+void BatchCreator::createBatch() {
   LOG_INFO << "Creating Batch file";
-  this->writeStart();
-  this->writeHideShell();
-  this->writeCommands();
-  this->writeEnvVariables();
-  this->writePathVariables();
-  this->writeApplication();
-  this->writeEnd();
+
+  if (this->layout == Layout::MULTI_LINE ||
+      (this->layout == Layout::AUTO && this->exceedsLineLimit())) {
+    this->createMultiLineBatch();
+    return;
+  }
+
+  this->createScript(ENTRY_SIZE);
 }
 
-void BatchCreator::writeStart() const {
+void BatchCreator::writeStart() {
   LOG_INFO << "writing Start of Batch";
   // {ReqFunc24} - \r\n
-  *this->dataStream << "@ECHO OFF\r\nC:\\Windows\\System32\\cmd.exe ";
+  this->content.append("@ECHO OFF\r\nC:\\Windows\\System32\\cmd.exe ");
+  this->writeHideShell();
 }
 
-void BatchCreator::writeHideShell() const {
+void BatchCreator::writeHideShell() {
   if (this->fileData->getHideShell()) {
     LOG_INFO << "writing hide Shell";
-    *this->dataStream << "/c ";
+    this->content.append("/c ");
   } else {
     LOG_INFO << "writing show Shell";
-    *this->dataStream << "/k ";
+    this->content.append("/k ");
   }
 }
 
-void BatchCreator::writeCommands() const {
+void BatchCreator::writeCommands() {
   LOG_INFO << "writing Commands";
-  *this->dataStream << "\"";
+  this->content.append("\"");
 
-  for (const std::string &command : this->fileData->getCommands()) {
-    *this->dataStream << command << " && ";
+  for (const auto &command : this->fileData->getCommands()) {
+    this->content.append(command).append(" && ");
   }
 }
 
-void BatchCreator::writeEnvVariables() const {
+void BatchCreator::writeEnvVariables() {
   LOG_INFO << "writing Environment Variables";
 
   for (const auto &[key, value] : this->fileData->getEnvironmentVariables()) {
-    *this->dataStream << "set " << key << "=" << value << " && ";
+    this->content.append("set ").append(key).append("=").append(value).append(
+        " && ");
   }
 }
 
-void BatchCreator::writePathVariables() const {
+void BatchCreator::writePathVariables() {
   LOG_INFO << "writing Path Variables";
-  *this->dataStream << "set path=";
+  this->content.append("set path=");
 
-  for (const std::string &path : this->fileData->getPathValues()) {
-    *this->dataStream << path << ";";
+  for (const auto &path : this->fileData->getPathValues()) {
+    this->content.append(path).append(";");
   }
 
-  *this->dataStream << "%path%";
+  this->content.append("%path%");
 }
 
-void BatchCreator::writeApplication() const {
-  std::string appName = this->fileData->getOutputFile();
-  appName = appName.substr(0, appName.find('.'));
-
+void BatchCreator::writeApplication() {
   if (this->fileData->getApplication().has_value()) {
     LOG_INFO << "writing start Application";
-    *this->dataStream << " && start \"" << appName
-                      << "\" "
-                      // {ReqFunc24} - \r\n
-                      << this->fileData->getApplication().value() << "\"\r\n";
+    this->content.append(" && start \"")
+        .append(this->getName())
+        .append("\" ")
+        .append(this->fileData->getApplication().value())
+        // {ReqFunc24} - \r\n
+        .append("\"\r\n");
   } else {
     LOG_INFO << "writing not start Application";
     // {ReqFunc24} - \r\n
-    *this->dataStream << "\"\r\n";
+    this->content.append("\"\r\n");
+  }
+}
+
+void BatchCreator::writeEnd() { this->content.append("@ECHO ON"); }
+
+bool BatchCreator::exceedsLineLimit() const {
+  const std::size_t limit = MAX_LINE_LENGTH - EXPANSION_RESERVE;
+  // cmd.exe, the switch, the quotes, "set path=", "%path%" and "start"
+  std::size_t length = BASE_SIZE + this->fileData->getOutputFile().size();
+
+  if (const auto application = this->fileData->getApplication()) {
+    length += application->size();
+  }
+
+  for (const auto &command : this->fileData->getCommands()) {
+    length += command.size() + std::string_view(" && ").size();
+
+    if (length > limit) {
+      return true;
+    }
+  }
+
+  for (const auto &[key, value] : this->fileData->getEnvironmentVariables()) {
+    length += std::string_view("set = && ").size() + key.size() + value.size();
+
+    if (length > limit) {
+      return true;
+    }
+  }
+
+  for (const auto &path : this->fileData->getPathValues()) {
+    length += path.size() + 1;
+
+    if (length > limit) {
+      return true;
+    }
+  }
+
+  return length > limit;
+}
+
+void BatchCreator::createMultiLineBatch() {
+  LOG_INFO << "Creating multi-line Batch file";
+  this->reserve(MULTI_LINE_ENTRY_SIZE);
+  // {ReqFunc24} - \r\n
+  this->content.append("@ECHO OFF\r\nsetlocal\r\n");
+  this->writeMultiLineCommands();
+  this->writeMultiLineEnvVariables();
+  this->writeMultiLinePathVariables();
+  this->writeMultiLineEnd();
+}
+
+void BatchCreator::writeMultiLineCommands() {
+  LOG_INFO << "writing Commands";
+
+  for (const auto &command : this->fileData->getCommands()) {
+    this->content.append("call ").append(command).append(
+        " || goto end\r\n");
+  }
+}
+
+void BatchCreator::writeMultiLineEnvVariables() {
+  LOG_INFO << "writing Environment Variables";
+
+  for (const auto &[key, value] : this->fileData->getEnvironmentVariables()) {
+    this->content.append("set ").append(key).append("=").append(value).append(
+        "\r\n");
   }
 }
 
-void BatchCreator::writeEnd() const { *this->dataStream << "@ECHO ON"; }
+void BatchCreator::writeMultiLinePathVariables() {
+  const auto paths = this->fileData->getPathValues();
+
+  if (paths.empty()) {
+    return;
+  }
+
+  LOG_INFO << "writing Path Variables";
+  std::vector<std::size_t> chunks;
+  std::size_t chunkLength = 0;
+
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    if (chunks.empty() || chunkLength + paths[i].size() > PATH_CHUNK_SIZE) {
+      chunks.push_back(i);
+      chunkLength = 0;
+    }
+
+    chunkLength += paths[i].size() + 1;
+  }
+
+  // !path! is expanded after the line has been read, so PATH may grow
+  // beyond the line limit
+  this->content.append("setlocal EnableDelayedExpansion\r\n");
+  std::size_t end = paths.size();
+
+  for (auto start = chunks.rbegin(); start != chunks.rend(); ++start) {
+    this->content.append("set \"path=");
+
+    for (std::size_t i = *start; i < end; ++i) {
+      this->appendDelayedExpansion(paths[i]);
+      this->content.append(";");
+    }
+
+    this->content.append("!path!\"\r\n");
+    end = *start;
+  }
+
+  // The application and commands may contain "!" again
+  this->content.append("setlocal DisableDelayedExpansion\r\n");
+}
+
+void BatchCreator::appendDelayedExpansion(std::string_view value) {
+  for (std::size_t caret = value.find('^'); caret != std::string_view::npos;
+       caret = value.find('^')) {
+    this->content.append(value.substr(0, caret + 1)).append("^");
+    value.remove_prefix(caret + 1);
+  }
+
+  this->content.append(value);
+}
+
+void BatchCreator::writeMultiLineEnd() {
+  if (this->fileData->getApplication().has_value()) {
+    LOG_INFO << "writing start Application";
+    this->content.append("start \"")
+        .append(this->getName())
+        .append("\" ")
+        .append(this->fileData->getApplication().value())
+        .append("\r\n");
+  }
+
+  // A failed command skips to the end, the shell is still opened
+  this->content.append(":end\r\n");
+
+  if (!this->fileData->getHideShell()) {
+    LOG_INFO << "writing show Shell";
+    this->content.append("C:\\Windows\\System32\\cmd.exe /k\r\n");
+  }
+
+  this->writeEnd();
+}
@@ -13,9 +13,13 @@
 #include "CommandLineHandler.hpp"
 #include "LoggingWrapper.hpp"
 #include "config.hpp"
+#include <algorithm>
+#include <charconv>
 #include <cstdlib>
 #include <cstring>
 #include <getopt.h>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
 namespace cli {
@@ -29,15 +33,50 @@ void CommandLineHandler::printHelp() {
            << RESET << "----------\n"
            << "-o, --outdir\t [path]\t\tOutput the batch file to the given "
            "dir\n"
+           << "-j, --jobs\t [number]\tConvert on this many threads, 0 for "
+           "all cores\n"
+           << "-D, --define\t [name=value]\tReplace ${name} within the values "
+           "by value\n"
            << "-h, --help\t\t\tPrint this help message\n"
            << "-v, --version\t\t\tPrint the version number\n"
            << "-c, --credits\t\t\tPrint the credits\n\n"
            << "    --verbose\t\t\tStart the application in verbose mode\n"
            << ITALIC
-           << "          \t\t\tNote: Verbose flag should be passed first!\n\n"
+           << "          \t\t\tNote: Verbose flag should be passed first!\n"
+           << RESET
+           << "    --no-io-uring\t\tDon't batch file I/O using io_uring\n"
+           << "    --stats\t\t\tPrint allocation statistics when done\n"
+           << "    --emit-snapshot\t\tAlso write a .j2b snapshot per file\n"
+           << "    --stdout\t\t\tWrite the batch files to stdout\n"
+           << "    --archive [path]\t\tWrite the batch files into a tar "
+           "archive\n"
+           << "    --include [glob]\t\tOnly take matching files from "
+           "directories\n"
+           << "    --exclude [glob]\t\tSkip matching files and directories\n"
+           << "    --ignore-file [name]\tSkip what ignore files with this name "
+           "list\n"
+           << "    --files-from [path]\t\tConvert the files listed in the file, "
+           "- for stdin\n"
+           << "    --layout [layout]\t\tauto, single or multi, multi writes "
+           "one\n"
+           << "          \t\t\tstatement per line for large files\n"
+           << "    --optimize\t\t\tRemove duplicate PATH entries and "
+           "variables\n"
+           << "    --format [formats]\t\tbat, ps1 and/or sh, separated by "
+           "commas,\n"
+           << "          \t\t\tall are written from one parse\n"
+           << "    --defines [path]\t\tRead name=value lines from the file\n\n"
            << RESET << BOLD << "Filenames:\n"
            << RESET << "----------\n"
            << "The json files to be processed into batch files.\n"
+           << "A file may contain an array of configurations or one\n"
+           << "configuration per line (JSON Lines).\n"
+           << "Snapshots (.j2b) are converted without parsing.\n"
+           << "\"-\" reads the configurations from stdin.\n"
+           << "Directories are searched recursively, the batch files\n"
+           << "mirror the directories within the output directory.\n"
+           << "@[path] converts the files listed in the file, one per line\n"
+           << "or separated by NUL characters.\n"
            << "Multiple files should be seperated by spaces!\n\n";
     exit(0);
 }
@@ -65,16 +104,14 @@ void CommandLineHandler::printCredits() {
     exit(0);
 }
 
-std::tuple<std::optional<std::string>, std::vector<std::string>>
-CommandLineHandler::parseArguments(int argc, char *argv[]) {
+Arguments CommandLineHandler::parseArguments(int argc, char *argv[]) {
     LOG_INFO << "Parsing arguments...";
-    std::vector<std::string> files;
-    std::optional<std::string> outDir;
+    Arguments arguments;
 
     while (true) {
         int optIndex = -1;
         struct option longOption = {};
-        const auto result = getopt_long(argc, argv, "hvco:", options, &optIndex);
+        const auto result = getopt_long(argc, argv, "hvco:j:D:", options, &optIndex);
 
         if (result == -1) {
             LOG_INFO << "End of options reached";
@@ -100,7 +137,26 @@ CommandLineHandler::parseArguments(int argc, char *argv[]) {
 
         case 'o':
             LOG_INFO << "Output option detected";
-            outDir = optarg;
+            arguments.outDir = optarg;
+            break;
+
+        case 'j': {
+            LOG_INFO << "Jobs option detected";
+            const std::string_view jobs = optarg;
+            const auto [end, error] = std::from_chars(
+                                          jobs.data(), jobs.data() + jobs.size(), arguments.jobs);
+
+            if (error != std::errc() || end != jobs.data() + jobs.size()) {
+                LOG_ERROR << "Invalid number of jobs: " << jobs;
+                exit(1);
+            }
+
+            break;
+        }
+
+        case 'D':
+            LOG_INFO << "Define option detected";
+            arguments.defines.emplace_back(optarg);
             break;
 
         case 0:
@@ -111,6 +167,77 @@ CommandLineHandler::parseArguments(int argc, char *argv[]) {
             if (strcmp(longOption.name, "verbose") == 0) {
                 logging::setVerboseMode(true);
                 LOG_INFO << "Verbose mode activated";
+            } else if (strcmp(longOption.name, "no-io-uring") == 0) {
+                arguments.ioUring = false;
+                LOG_INFO << "io_uring deactivated";
+            } else if (strcmp(longOption.name, "stats") == 0) {
+                arguments.stats = true;
+                LOG_INFO << "Statistics activated";
+            } else if (strcmp(longOption.name, "emit-snapshot") == 0) {
+                arguments.emitSnapshot = true;
+                LOG_INFO << "Snapshots activated";
+            } else if (strcmp(longOption.name, "stdout") == 0) {
+                arguments.toStdout = true;
+                LOG_INFO << "Writing to stdout";
+            } else if (strcmp(longOption.name, "archive") == 0) {
+                arguments.archive = optarg;
+                LOG_INFO << "Writing to the archive " << optarg;
+            } else if (strcmp(longOption.name, "include") == 0) {
+                arguments.includes.emplace_back(optarg);
+                LOG_INFO << "Including " << optarg;
+            } else if (strcmp(longOption.name, "exclude") == 0) {
+                arguments.excludes.emplace_back(optarg);
+                LOG_INFO << "Excluding " << optarg;
+            } else if (strcmp(longOption.name, "ignore-file") == 0) {
+                arguments.ignoreFile = optarg;
+                LOG_INFO << "Using ignore files named " << optarg;
+            } else if (strcmp(longOption.name, "files-from") == 0) {
+                arguments.fileLists.emplace_back(optarg);
+                LOG_INFO << "Reading files from " << optarg;
+            } else if (strcmp(longOption.name, "layout") == 0) {
+                const std::string_view layout = optarg;
+
+                if (layout == "auto") {
+                    arguments.layout = BatchCreator::Layout::AUTO;
+                } else if (layout == "single") {
+                    arguments.layout = BatchCreator::Layout::SINGLE_LINE;
+                } else if (layout == "multi") {
+                    arguments.layout = BatchCreator::Layout::MULTI_LINE;
+                } else {
+                    LOG_ERROR << "Invalid layout: " << layout;
+                    exit(1);
+                }
+
+                LOG_INFO << "Using the layout " << layout;
+            } else if (strcmp(longOption.name, "optimize") == 0) {
+                arguments.optimize = true;
+                LOG_INFO << "Optimizing the entries";
+            } else if (strcmp(longOption.name, "format") == 0) {
+                std::string_view list = optarg;
+                arguments.formats.clear();
+
+                while (!list.empty() || arguments.formats.empty()) {
+                    const std::string_view name = list.substr(0, list.find(','));
+                    const auto format = parseScriptFormat(name);
+
+                    if (!format) {
+                        LOG_ERROR << "Invalid format: " << name;
+                        exit(1);
+                    }
+
+                    // Each format is written once
+                    if (std::ranges::find(arguments.formats, *format) ==
+                            arguments.formats.end()) {
+                        arguments.formats.push_back(*format);
+                    }
+
+                    list.remove_prefix(std::min(list.size(), name.size() + 1));
+                }
+
+                LOG_INFO << "Writing the formats " << optarg;
+            } else if (strcmp(longOption.name, "defines") == 0) {
+                arguments.definesFiles.emplace_back(optarg);
+                LOG_INFO << "Reading defines from " << optarg;
             }
 
             break;
@@ -126,12 +253,21 @@ CommandLineHandler::parseArguments(int argc, char *argv[]) {
 
     // Loop for {reqFunc5}
     while (optind < argc) {
-        LOG_INFO << "Adding file: " << argv[optind];
+        const std::string_view argument = argv[optind++];
+
+        // A response file, which lists the files instead of the arguments
+        if (argument.size() > 1 && argument.starts_with('@')) {
+            LOG_INFO << "Adding the files listed in: " << argument.substr(1);
+            arguments.fileLists.emplace_back(argument.substr(1));
+            continue;
+        }
+
+        LOG_INFO << "Adding file: " << argument;
         // Vector for {reqFunc7}
-        files.emplace_back(argv[optind++]);
+        arguments.files.emplace_back(argument);
     }
 
     LOG_INFO << "Arguments and options have been parsed";
-    return {outDir, files};
+    return arguments;
 }
 } // namespace cli
@@ -0,0 +1,1230 @@
+/**
+ * @file ConversionPipeline.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-10
+ * @version 0.3.0
+ * @brief Implementation of the ConversionPipeline class.
+ *
+ * @see src/include/ConversionPipeline.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "ConversionPipeline.hpp"
+#include "BatchCreator.hpp"
+#include "CommandLineHandler.hpp"
+#include "Exceptions.hpp"
+#include "JsonHandler.hpp"
+#include "JsonSplitter.hpp"
+#include "LoggingWrapper.hpp"
+#include "Optimizer.hpp"
+#include "ParallelChunks.hpp"
+#include "PowerShellCreator.hpp"
+#include "ShellCreator.hpp"
+#include "Snapshot.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace parsing {
+namespace {
+// Of the workers of the last run, by their index
+std::mutex statisticsMutex;
+std::vector<ConversionPipeline::WorkerStatistics> workerStatistics;
+// Size of the configuration the thread converts, its chunks are as urgent
+thread_local std::size_t convertingSize = 0;
+} // namespace
+
+ConversionPipeline::ConversionPipeline(const utilities::FileList &files,
+                                       Options options)
+    : files(files), options(std::move(options)) {
+    LOG_INFO << "Initializing ConversionPipeline";
+
+    // Nothing is written to files with the standard output or an archive
+    if (!this->options.archive.empty()) {
+        this->archive.emplace(this->options.archive);
+    } else if (this->options.useIoUring && !this->options.toStandardOutput) {
+        this->writeRing.emplace();
+    }
+}
+
+void ConversionPipeline::run() {
+    LOG_INFO << "Starting pipeline for " << this->files.size() << " files so far";
+    this->reader = std::thread(&ConversionPipeline::readStage, this);
+
+    // A single job is converted by the conversion stage itself
+    for (unsigned i = 0;
+            this->options.jobCount > 1 && i < this->options.jobCount; ++i) {
+        this->workers.emplace_back(&ConversionPipeline::workerStage, this, i);
+    }
+
+    // Chunks of huge configurations are processed by idle workers, so no
+    // further threads are started
+    if (!this->workers.empty()) {
+        utilities::ParallelChunks::setExecutor([this](std::function<void()> &chunk) {
+            Task task{.run = std::packaged_task<void()>(chunk), .chunk = true};
+            return this->jobs.tryPush(task, convertingSize);
+        }, this->workers.size());
+    }
+
+    this->converter = std::thread(&ConversionPipeline::convertStage, this);
+
+    this->writeStage();
+    this->stop();
+
+    if (this->archive) {
+        this->archive->finish();
+    }
+
+    if (this->duplicates > 0) {
+        OUTPUT << "Copied " << this->duplicates << " batch files of identical "
+               "configurations instead of converting them\n";
+    }
+}
+
+void ConversionPipeline::stop() {
+    this->inputs.close();
+    this->jobs.close();
+    this->outputs.close();
+
+    if (this->reader.joinable()) {
+        this->reader.join();
+    }
+
+    if (this->converter.joinable()) {
+        this->converter.join();
+    }
+
+    for (auto &worker : this->workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    utilities::ParallelChunks::setExecutor(nullptr, 1);
+}
+
+void ConversionPipeline::readStage() {
+    LOG_INFO << "Reader stage started";
+    // The ring isn't thread safe, so the reader uses it's own
+    std::optional<utilities::IoUring> readRing;
+
+    if (this->options.useIoUring) {
+        readRing.emplace();
+    }
+
+    // With io_uring the files are read in batches
+    const std::size_t batchSize =
+        readRing ? std::min(utilities::IoUring::BATCH_SIZE, PREFETCH_DEPTH) : 1;
+
+    // Waits for the next file, while the list is still growing
+    for (std::size_t batchBegin = 0; this->files.wait(batchBegin);) {
+        // Only the files, which are already known, are read at once
+        std::vector<std::string> batch = this->files.available(batchBegin,
+                                         batchSize);
+
+        // The standard input is read on it's own, never by io_uring
+        if (batch.front() == STANDARD_INPUT) {
+            if (!this->readStandardInput(batchBegin)) {
+                LOG_INFO << "Reader stage stopped";
+                return;
+            }
+
+            ++batchBegin;
+            continue;
+        }
+
+        batch.erase(std::find(batch.begin(), batch.end(), STANDARD_INPUT),
+                    batch.end());
+        std::vector<std::optional<utilities::InputFile>> contents;
+
+        if (readRing) {
+            contents = readRing->readFiles(batch);
+        } else {
+            contents.resize(batch.size());
+        }
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            Input input{batchBegin + i, std::move(contents[i]), nullptr, ""};
+
+            // Files which weren't read by io_uring are loaded here
+            if (!input.content) {
+                std::ostringstream messages;
+                logging::captureConsoleOutput(&messages);
+
+                try {
+                    input.content.emplace(batch[i]);
+                } catch (const exceptions::CustomException &) {
+                    input.error = std::current_exception();
+                }
+
+                logging::captureConsoleOutput(nullptr);
+                input.messages = messages.str();
+            }
+
+            // Blocks while the conversion stage is PREFETCH_DEPTH files behind
+            if (!this->inputs.push(std::move(input))) {
+                LOG_INFO << "Reader stage stopped";
+                return;
+            }
+        }
+
+        batchBegin += batch.size();
+    }
+
+    this->inputs.close();
+    LOG_INFO << "Reader stage finished";
+}
+
+bool ConversionPipeline::readStandardInput(std::size_t file) {
+    LOG_INFO << "Reading configurations from the standard input";
+    // Only the configuration, which isn't complete yet, is kept
+    std::string buffer;
+    std::size_t position = 0;
+    std::optional<std::size_t> start;
+    JsonSplitter::ScanState state;
+    std::size_t line = 1;
+    std::size_t startLine = 1;
+    bool isFirst = true;
+    bool isArray = false;
+    bool atEnd = false;
+    // The first configuration, until it's known whether others follow
+    std::optional<Input> first;
+
+    const auto releaseFirst = [&](bool hasMore) {
+        if (!first) {
+            return true;
+        }
+
+        first->hasMore = hasMore;
+        const bool pushed = this->inputs.push(std::move(*first));
+        first.reset();
+        return pushed;
+    };
+
+    // Passes on the configuration from start to end
+    const auto push = [&](std::size_t end) {
+        Input input{file, utilities::InputFile::allocate(end - *start), nullptr,
+                    "", isArray ? 0 : startLine};
+        std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(*start),
+                  buffer.begin() + static_cast<std::ptrdiff_t>(end),
+                  input.content->writableData());
+        start.reset();
+        state = {};
+
+        if (isFirst && !isArray) {
+            isFirst = false;
+            first = std::move(input);
+            return true;
+        }
+
+        isFirst = false;
+        return this->inputs.push(std::move(input));
+    };
+
+    while (!atEnd) {
+        const std::size_t previousSize = buffer.size();
+        buffer.resize(previousSize + STANDARD_INPUT_CHUNK);
+
+        try {
+            const std::size_t length = utilities::InputFile::readStandardInput(
+                                           buffer.data() + previousSize, STANDARD_INPUT_CHUNK);
+            buffer.resize(previousSize + length);
+            atEnd = length == 0;
+        } catch (const exceptions::CustomException &) {
+            return releaseFirst(true) &&
+                   this->inputs.push({file, std::nullopt, std::current_exception(),
+                                      "", line});
+        }
+
+        // A top level array is split by the conversion stage, once it is
+        // read completely
+        while (!isArray && position < buffer.size()) {
+            if (!start) {
+                if (std::isspace(static_cast<unsigned char>(buffer[position])) != 0) {
+                    line += buffer[position] == '\n' ? 1 : 0;
+                    ++position;
+                    continue;
+                }
+
+                start = position;
+                startLine = line;
+                isArray = isFirst && buffer[position] == '[';
+
+                if (!releaseFirst(true)) {
+                    return false;
+                }
+
+                if (isArray) {
+                    break;
+                }
+            }
+
+            const auto end = JsonSplitter::scan(buffer, position, state);
+
+            if (!end) {
+                position = buffer.size();
+                break;
+            }
+
+            // E.g. a closing bracket without an opening one, which is
+            // reported by the parser
+            position = std::max(*end, *start + 1);
+            line += static_cast<std::size_t>(std::count(
+                                                 buffer.begin() + static_cast<std::ptrdiff_t>(*start),
+                                                 buffer.begin() + static_cast<std::ptrdiff_t>(position), '\n'));
+
+            if (!push(position)) {
+                return false;
+            }
+        }
+
+        // Everything before the current configuration has been passed on
+        const std::size_t consumed = start.value_or(position);
+        buffer.erase(0, consumed);
+        position -= consumed;
+
+        if (start) {
+            start = 0;
+        }
+    }
+
+    // Unterminated configurations are reported by the parser
+    if (start && !push(buffer.size())) {
+        return false;
+    }
+
+    return releaseFirst(false);
+}
+
+void ConversionPipeline::convertStage() {
+    LOG_INFO << "Conversion stage started";
+
+    while (auto input = this->inputs.pop()) {
+        if (!this->split(*input)) {
+            LOG_INFO << "Conversion stage stopped";
+            return;
+        }
+    }
+
+    // The workers keep running until everything is written, as they take
+    // the chunks of huge configurations, see stop()
+    this->outputs.close();
+    LOG_INFO << "Conversion stage finished";
+}
+
+std::vector<ConversionPipeline::WorkerStatistics>
+ConversionPipeline::getWorkerStatistics() {
+    std::scoped_lock lock(statisticsMutex);
+    return workerStatistics;
+}
+
+void ConversionPipeline::workerStage(std::size_t worker) {
+    LOG_INFO << "Worker " << worker << " started";
+    const auto started = std::chrono::steady_clock::now();
+    WorkerStatistics statistics;
+
+    while (auto job = this->jobs.pop()) {
+        const auto begin = std::chrono::steady_clock::now();
+        job->run();
+
+        // Chunks are part of a configuration another worker converts
+        if (job->chunk) {
+            statistics.busy += std::chrono::steady_clock::now() - begin;
+            ++statistics.chunks;
+            continue;
+        }
+
+        statistics.finished = std::chrono::steady_clock::now();
+        statistics.busy += statistics.finished - begin;
+        statistics.longest = std::max<std::chrono::nanoseconds>(
+                                 statistics.longest, statistics.finished - begin);
+        ++statistics.configurations;
+    }
+
+    statistics.alive = std::chrono::steady_clock::now() - started;
+
+    {
+        std::scoped_lock lock(statisticsMutex);
+        workerStatistics.resize(std::max(workerStatistics.size(), worker + 1));
+        workerStatistics[worker] = statistics;
+    }
+
+    LOG_INFO << "Worker " << worker << " finished";
+}
+
+bool ConversionPipeline::split(Input &input) {
+    // Unknown while the list is still growing
+    const bool isLastFile = this->files.isLast(input.file);
+    Job job{.file = input.file, .name = this->files[input.file],
+            .hasMore = !isLastFile || input.hasMore, .error = input.error,
+            .messages = std::move(input.messages)};
+
+    // Configurations read from the standard input one by one
+    if (input.line > 0) {
+        job.name += ":" + std::to_string(input.line);
+    }
+
+    // Snapshots always contain a single configuration
+    if (job.error || Snapshot::isSnapshot(input.content->view())) {
+        if (!job.error) {
+            job.input = std::make_shared<const utilities::InputFile>(
+                            std::move(*input.content));
+            job.content = job.input->view();
+        }
+
+        return this->dispatch(std::move(job));
+    }
+
+    // Shared by all configurations of the file, freed after the last one
+    job.input = std::make_shared<const utilities::InputFile>(
+                    std::move(*input.content));
+    input.content.reset();
+
+    // The output is printed by the writer stage, with the next job
+    std::ostringstream messages;
+    std::exception_ptr error;
+    const auto next = [&messages, &error](JsonSplitter & splitter)
+    -> std::optional<JsonSplitter::Element> {
+        logging::captureConsoleOutput(&messages);
+
+        try {
+            auto element = splitter.next();
+            logging::captureConsoleOutput(nullptr);
+            return element;
+        } catch (const exceptions::CustomException &) {
+            error = std::current_exception();
+        }
+
+        logging::captureConsoleOutput(nullptr);
+        return std::nullopt;
+    };
+
+    JsonSplitter splitter(this->files[input.file], job.input->view());
+    auto element = next(splitter);
+
+    // Finding the following element first tells if this one is the last
+    while (element) {
+        auto following = next(splitter);
+        Job elementJob = job;
+        elementJob.content = element->content;
+        elementJob.hasMore = job.hasMore || following || error;
+
+        if (splitter.getLayout() == JsonSplitter::Layout::ARRAY) {
+            elementJob.name += "[" + std::to_string(element->index) + "]";
+        } else if (splitter.getLayout() == JsonSplitter::Layout::LINES) {
+            elementJob.name += ":" + std::to_string(element->line);
+        }
+
+        elementJob.messages += messages.str();
+        messages.str("");
+        // The messages of reading the file are only printed once
+        job.messages.clear();
+
+        if (!this->dispatch(std::move(elementJob))) {
+            return false;
+        }
+
+        element = std::move(following);
+    }
+
+    if (error) {
+        job.input.reset();
+        job.error = error;
+        job.messages += messages.str();
+        return this->dispatch(std::move(job));
+    }
+
+    return true;
+}
+
+bool ConversionPipeline::dispatch(Job job) {
+    // Blocks while the writer stage is PREFETCH_DEPTH configurations behind
+    const std::optional<std::size_t> slot = this->outputs.reserve();
+
+    if (!slot) {
+        return false;
+    }
+
+    job.sequence = this->nextSequence++;
+    Pending pending{.sequence = job.sequence, .hasMore = job.hasMore};
+
+    // Identical configurations are copied by the writer, which is only
+    // possible when writing files
+    if (!job.error && !this->options.toStandardOutput && !this->archive &&
+            job.content.size() <= MAX_ORIGINAL_BYTES) {
+        const ContentHash hash = hashContent(job.content);
+        const auto original = this->contents.find(hash);
+
+        if (original == this->contents.end()) {
+            this->remember(hash, job);
+        } else if (const Original &first = original->second;
+                   first.content == job.content) {
+            // The parsed original tells whether it can be copied, until it
+            // is parsed the writer decides
+            const Reuse reuse = first.reuse->load();
+            const bool copied = reuse == Reuse::COPY || reuse == Reuse::UNKNOWN ||
+                                (reuse == Reuse::SAME_DIRECTORY &&
+                                 first.directory == directoryOf(job.name));
+
+            if (copied) {
+                std::promise<Output> duplicate;
+                Output output{.file = job.file, .name = job.name,
+                              .hasMore = job.hasMore,
+                              .messages = std::move(job.messages),
+                              .sequence = job.sequence,
+                              .duplicateOf = first.sequence};
+                output.duplicate = std::move(job);
+                duplicate.set_value(std::move(output));
+                pending.output = duplicate.get_future();
+                pending.duplicateOf = first.sequence;
+                this->outputs.complete(*slot, std::move(pending));
+                return true;
+            }
+        }
+    }
+
+    // Larger configurations are taken first by the workers
+    const std::size_t size = job.content.size();
+    std::packaged_task<Output()> convert([this, job = std::move(job)]() mutable {
+        return this->convert(job);
+    });
+    pending.output = convert.get_future();
+    // Errors are passed on within the future, so the slot is always completed
+    std::packaged_task<void()> task([this, slot = *slot,
+                                     convert = std::move(convert),
+                                     pending = std::move(pending)]() mutable {
+        convert();
+        this->outputs.complete(slot, std::move(pending));
+    });
+
+    if (this->options.jobCount <= 1) {
+        task();
+        return true;
+    }
+
+    return this->jobs.push(Task{.run = std::move(task)}, size);
+}
+
+void ConversionPipeline::remember(const ContentHash &hash, Job &job) {
+    while (!this->contentOrder.empty() &&
+            (this->contents.size() >= MAX_ORIGINALS ||
+             this->contentBytes + job.content.size() > MAX_ORIGINAL_BYTES)) {
+        const auto oldest = this->contents.find(this->contentOrder.front());
+        this->contentBytes -= oldest->second.content.size();
+        this->contents.erase(oldest);
+        this->contentOrder.pop_front();
+    }
+
+    job.reuse = std::make_shared<std::atomic<Reuse>>(Reuse::UNKNOWN);
+    this->contents.emplace(hash, Original{job.sequence, std::string(job.content),
+                                          std::string(directoryOf(job.name)), job.reuse});
+    this->contentOrder.push_back(hash);
+    this->contentBytes += job.content.size();
+}
+
+std::string_view ConversionPipeline::directoryOf(std::string_view name) {
+    return name.substr(0, name.find_last_of("/\\") + 1);
+}
+
+ConversionPipeline::ContentHash ConversionPipeline::hashContent(
+    std::string_view content) {
+    ContentHash hash{std::hash<std::string_view> {}(content), 14695981039346656037ULL};
+
+    for (const char c : content) {
+        hash.second = (hash.second ^ static_cast<unsigned char>(c)) *
+                      1099511628211ULL;
+    }
+
+    return hash;
+}
+
+ConversionPipeline::Output ConversionPipeline::convert(Job &job) {
+    // The output is printed by the writer stage, once it reaches the file
+    std::ostringstream messages;
+    logging::captureConsoleOutput(&messages);
+    convertingSize = job.content.size();
+    auto arena = this->arenas.acquire();
+    std::pmr::memory_resource *resource = arena->getResource();
+    Output output{.file = job.file, .name = std::move(job.name),
+                  .hasMore = job.hasMore, .arena = std::move(arena),
+                  .content = std::pmr::string(resource), .error = job.error,
+                  .sequence = job.sequence};
+
+    std::vector<Task> profileTasks;
+
+    // Only our exceptions are passed on, other exceptions are fatal
+    try {
+        if (!output.error) {
+            std::shared_ptr<FileData> fileData;
+            std::shared_ptr<JsonHandler> profiles;
+            bool hasBases = false;
+
+            // Snapshots are already validated and don't have to be parsed
+            if (Snapshot::isSnapshot(job.content)) {
+                fileData = Snapshot::load(output.name, job.content, resource);
+            } else if (job.content.find("\"profiles\"") != std::string_view::npos) {
+                // Shared by the profiles, which outlive the arena. The text
+                // only hints at profiles, the parsed configuration decides.
+                auto jsonHandler = std::make_shared<JsonHandler>(output.name,
+                                   job.content);
+                hasBases = jsonHandler->hasBases();
+
+                if (jsonHandler->getProfiles().empty()) {
+                    fileData = jsonHandler->getFileData();
+                } else {
+                    profiles = std::move(jsonHandler);
+                }
+            } else {
+                JsonHandler jsonHandler(output.name, job.content, resource);
+                hasBases = jsonHandler.hasBases();
+                fileData = jsonHandler.getFileData();
+            }
+
+            // The content isn't needed anymore after parsing
+            job.input.reset();
+
+            if (profiles) {
+                profileTasks = this->convertProfiles(output, profiles,
+                                                     job.content.size());
+            } else {
+                this->createBatch(output, fileData);
+                output.copyable = true;
+
+                if (hasBases) {
+                    output.basesDirectory = std::string(directoryOf(output.name));
+                }
+            }
+        }
+    } catch (const exceptions::CustomException &) {
+        output.error = std::current_exception();
+        output.copyable = false;
+    } catch (const Json::Exception &) {
+        output.error = std::current_exception();
+        output.copyable = false;
+    }
+
+    logging::captureConsoleOutput(nullptr);
+
+    // Tells the conversion stage how to handle later identical ones
+    if (job.reuse) {
+        job.reuse->store(!output.copyable ? Reuse::CONVERT :
+                         output.basesDirectory ? Reuse::SAME_DIRECTORY : Reuse::COPY);
+    }
+    output.messages = std::move(job.messages);
+    output.messages += messages.str();
+
+    // Capture their own output, so they run after the configuration
+    for (auto &task : profileTasks) {
+        task.run();
+    }
+
+    return output;
+}
+
+void ConversionPipeline::createBatch(Output &output,
+                                     const std::shared_ptr<FileData> &fileData) {
+    if (this->options.optimize) {
+        Optimizer::optimize(*fileData);
+    }
+
+    // Full filename is output directory + output file
+    // {ReqFunc18}
+    std::string fileName = this->outputDirectory(output.file);
+    fileName += fileData->getOutputFile();
+    // The outputfile always ends with ".bat"
+    const std::string stem = fileName.substr(
+                                 0, fileName.size() - std::string_view(".bat").size());
+
+    for (const ScriptFormat format : this->options.formats) {
+        std::pmr::string content = this->createScript(format, fileData);
+
+        if (output.fileName.empty()) {
+            output.fileName = format == ScriptFormat::BAT ? fileName :
+                              stem + std::string(getExtension(format));
+            output.content = std::move(content);
+        } else {
+            output.companions.push_back({stem + std::string(getExtension(format)),
+                                         std::move(content)});
+        }
+    }
+
+    if (this->options.emitSnapshot) {
+        output.companions.push_back({stem + std::string(Snapshot::EXTENSION),
+                                     Snapshot::serialize(*fileData, output.arena->getResource())});
+    }
+}
+
+std::pmr::string ConversionPipeline::createScript(ScriptFormat format,
+        const std::shared_ptr<FileData> &fileData) const {
+    // Each creator is a separate type, no fragment is written virtually
+    switch (format) {
+    case ScriptFormat::PS1:
+        return PowerShellCreator(fileData).takeContent();
+
+    case ScriptFormat::SH:
+        return ShellCreator(fileData).takeContent();
+
+    default:
+        return BatchCreator(fileData, this->options.layout).takeContent();
+    }
+}
+
+std::vector<ConversionPipeline::Task> ConversionPipeline::convertProfiles(Output &output,
+                                    const std::shared_ptr<JsonHandler> &jsonHandler, std::size_t size) {
+    // Parsed and validated once, each profile only adds its own values
+    std::shared_ptr<const FileData> shared = jsonHandler->getBaseFileData();
+    std::shared_ptr<const JsonHandler> handler = jsonHandler;
+    const std::vector<std::string> profiles = handler->getProfiles();
+    std::vector<Task> remaining;
+    LOG_INFO << "Creating " << profiles.size() << " profiles of " << output.name;
+
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        Job job{.file = output.file,
+                .name = output.name + "(" + profiles[i] + ")",
+                .hasMore = output.hasMore || i + 1 < profiles.size(),
+                .sequence = output.sequence};
+        std::packaged_task<Output()> task([this, handler, shared,
+                                          profile = profiles[i], job = std::move(job)]() mutable {
+            return this->convertProfile(job, *handler, profile, *shared);
+        });
+        output.variants.push_back(task.get_future());
+        Task profileTask{.run = std::packaged_task<void()>(std::move(task))};
+
+        // Emitted by the other workers, as long as they keep up
+        if (this->options.jobCount <= 1 || !this->jobs.tryPush(profileTask, size)) {
+            remaining.push_back(std::move(profileTask));
+        }
+    }
+
+    return remaining;
+}
+
+ConversionPipeline::Output ConversionPipeline::convertProfile(Job &job,
+        const JsonHandler &jsonHandler, const std::string &profile,
+        const FileData &shared) {
+    std::ostringstream messages;
+    logging::captureConsoleOutput(&messages);
+    auto arena = this->arenas.acquire();
+    std::pmr::memory_resource *resource = arena->getResource();
+    Output variant{.file = job.file, .name = std::move(job.name),
+                   .hasMore = job.hasMore, .arena = std::move(arena),
+                   .content = std::pmr::string(resource), .sequence = job.sequence};
+
+    try {
+        this->createBatch(variant, jsonHandler.getProfileFileData(profile, shared,
+                          resource));
+    } catch (const exceptions::CustomException &) {
+        variant.error = std::current_exception();
+    } catch (const Json::Exception &) {
+        variant.error = std::current_exception();
+    }
+
+    logging::captureConsoleOutput(nullptr);
+    variant.messages = messages.str();
+    return variant;
+}
+
+void ConversionPipeline::writeStage() {
+    LOG_INFO << "Writer stage started";
+    // Without io_uring every file is handled on it's own
+    const std::size_t batchSize =
+        this->writeRing ? utilities::IoUring::BATCH_SIZE : 1;
+    std::vector<Output> batch;
+    const auto writable = [this](const Pending &pending, std::size_t others) {
+        return this->isWritable(pending, others);
+    };
+
+    // Waits for the next converted configuration, if the workers are behind
+    while (auto pending = this->outputs.pop(writable)) {
+        this->markHandled(pending->sequence);
+        this->addToBatch(batch, pending->output.get());
+
+        // Take everything that is already converted, without waiting
+        while (batch.size() < batchSize) {
+            auto next = this->outputs.tryPop(writable);
+
+            if (!next) {
+                break;
+            }
+
+            this->markHandled(next->sequence);
+            this->addToBatch(batch, next->output.get());
+        }
+
+        this->writeBatch(batch);
+        this->releaseBatch(batch);
+    }
+
+    LOG_INFO << "Writer stage finished";
+}
+
+bool ConversionPipeline::isWritable(const Pending &pending,
+                                    std::size_t others) const {
+    // Copied from the files of the identical one, once they are written
+    if (pending.duplicateOf && *pending.duplicateOf >= this->handledBelow &&
+            !this->handled.contains(*pending.duplicateOf)) {
+        return false;
+    }
+
+    return pending.hasMore || others == 0;
+}
+
+void ConversionPipeline::markHandled(std::size_t sequence) {
+    this->handled.insert(sequence);
+
+    while (this->handled.erase(this->handledBelow) > 0) {
+        ++this->handledBelow;
+    }
+}
+
+void ConversionPipeline::releaseBatch(std::vector<Output> &batch) {
+    // The contents have to be freed before their arenas are reset
+    std::vector<std::unique_ptr<utilities::Arena>> usedArenas;
+    usedArenas.reserve(batch.size());
+
+    for (auto &written : batch) {
+        // Duplicates, which have been copied, never had an arena
+        if (written.arena) {
+            usedArenas.push_back(std::move(written.arena));
+        }
+    }
+
+    batch.clear();
+
+    for (auto &arena : usedArenas) {
+        this->arenas.release(std::move(arena));
+    }
+}
+
+void ConversionPipeline::rememberWritten(const Output &output) {
+    // Duplicates refer to the last MAX_ORIGINALS configurations. As files
+    // are written as they are completed, up to PREFETCH_DEPTH files before
+    // and after them may be written in between.
+    while (this->writtenOrder.size() >= MAX_ORIGINALS + 2 * PREFETCH_DEPTH) {
+        this->forgetWritten(this->writtenOrder.front());
+        this->writtenOrder.pop_front();
+    }
+
+    WrittenFile &file = this->writtenFiles[output.sequence];
+    file = {output.fileName, {}, this->outputDirectory(output.file).size(),
+            output.basesDirectory
+           };
+    this->writtenPaths[output.fileName] = output.sequence;
+
+    for (const auto &companion : output.companions) {
+        file.companions.push_back(companion.fileName);
+        this->writtenPaths[companion.fileName] = output.sequence;
+    }
+
+    this->writtenOrder.push_back(output.sequence);
+}
+
+void ConversionPipeline::forgetWritten(std::size_t sequence) {
+    const auto file = this->writtenFiles.find(sequence);
+
+    if (file == this->writtenFiles.end()) {
+        return;
+    }
+
+    // A path may already belong to a later file
+    const auto forgetPath = [this, sequence](const std::string &fileName) {
+        const auto path = this->writtenPaths.find(fileName);
+
+        if (path != this->writtenPaths.end() && path->second == sequence) {
+            this->writtenPaths.erase(path);
+        }
+    };
+
+    forgetPath(file->second.fileName);
+
+    for (const auto &companion : file->second.companions) {
+        forgetPath(companion);
+    }
+
+    this->writtenFiles.erase(file);
+}
+
+void ConversionPipeline::forgetOverwritten(const Output &output) {
+    const auto forgetPath = [this](const std::string &fileName) {
+        const auto path = this->writtenPaths.find(fileName);
+
+        if (path != this->writtenPaths.end()) {
+            this->forgetWritten(path->second);
+        }
+    };
+
+    forgetPath(output.fileName);
+
+    for (const auto &companion : output.companions) {
+        forgetPath(companion.fileName);
+    }
+}
+
+void ConversionPipeline::writeBatch(std::vector<Output> &batch) {
+    std::vector<const Output *> toWrite;
+    // Index within toWrite, as a file may be created twice within a batch
+    std::unordered_map<std::string_view, std::size_t> pending;
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        Output &output = batch[i];
+
+        if (output.duplicate) {
+            this->resolveDuplicate(output);
+
+            // Converted after all, its profiles are written on their own
+            if (!output.variants.empty()) {
+                std::vector<Output> profiles;
+                this->addToBatch(profiles, std::move(output));
+                this->writeBatch(profiles);
+                this->releaseBatch(profiles);
+                continue;
+            }
+        }
+
+        OUTPUT << cli::ITALIC << "\nParsing file: " << output.name << "...\n"
+               << cli::RESET;
+        // Already written to the logfile by the other stages
+        logging::consoleOutput() << output.messages;
+
+        if (output.error) {
+            this->runForFile([&] {
+                std::rethrow_exception(output.error);
+            }, output);
+            continue;
+        }
+
+        // Nothing is overwritten on the standard output
+        if (this->options.toStandardOutput) {
+            this->runForFile([&] {
+                this->writeStandardOutput(output);
+            }, output);
+            continue;
+        }
+
+        // Files can't be replaced within the archive, the last one is
+        // extracted instead
+        if (this->archive) {
+            if (!this->archived.insert(output.fileName).second) {
+                if (!utilities::Utils::askToContinue(
+                            "The file already exists in the archive, do you want to "
+                            "overwrite it? (y/n) ")) {
+                    OUTPUT << "Skipping file...\n";
+                    continue;
+                }
+                OUTPUT << "Overwriting file...\n";
+            }
+
+            this->runForFile([&] {
+                this->writeArchive(output);
+            }, output);
+            continue;
+        }
+
+        // The files of searched directories mirror their directories
+        const bool created = this->runForFile([&] {
+            this->createSubdirectory(output);
+        }, output);
+
+        if (!created) {
+            continue;
+        }
+
+        const auto previous = pending.find(output.fileName);
+
+        if (previous != pending.end() ||
+                this->outputCache.isRegularFile(output.fileName)) {
+            if (!utilities::Utils::askToContinue(
+                        "The file already exists, do you want to overwrite it? (y/n) ")) {
+                OUTPUT << "Skipping file...\n";
+                continue;
+            }
+            OUTPUT << "Overwriting file...\n";
+        }
+
+        // Identical configurations can't be copied from the files anymore,
+        // whether they were written by this batch or an earlier one
+        this->forgetOverwritten(output);
+
+        // Only the last version is written
+        if (previous != pending.end()) {
+            toWrite[previous->second] = &output;
+        } else {
+            pending.emplace(output.fileName, toWrite.size());
+            toWrite.push_back(&output);
+        }
+
+        // Later duplicates within the batch are copied once it is written
+        if (!output.duplicate && output.copyable) {
+            this->rememberWritten(output);
+        }
+    }
+
+    // Companions are written along with their batch file, without asking
+    std::vector<utilities::OutputFile> outputFiles;
+    std::vector<const Output *> owners;
+    outputFiles.reserve(toWrite.size());
+    owners.reserve(toWrite.size());
+
+    for (const auto *output : toWrite) {
+        if (output->duplicate) {
+            continue;
+        }
+
+        outputFiles.push_back({output->fileName, output->content});
+        owners.push_back(output);
+
+        for (const auto &companion : output->companions) {
+            outputFiles.push_back({companion.fileName, companion.content});
+            owners.push_back(output);
+        }
+    }
+
+    std::vector<bool> written(outputFiles.size(), false);
+
+    if (this->writeRing) {
+        written = this->writeRing->writeFiles(outputFiles);
+    }
+
+    // Everything that wasn't written yet uses the portable path
+    for (std::size_t i = 0; i < outputFiles.size(); ++i) {
+        if (!written[i]) {
+            written[i] = this->runForFile([&] {
+                writeOutput(outputFiles[i]);
+            }, *owners[i]);
+        }
+
+        // Later batches of the same run have to see the new file
+        if (written[i]) {
+            this->outputCache.addFile(outputFiles[i].fileName);
+        } else {
+            this->forgetWritten(owners[i]->sequence);
+        }
+    }
+
+    for (const auto *output : toWrite) {
+        if (output->duplicate && this->runForFile([&] {
+        this->copyDuplicate(*output);
+        }, *output)) {
+            this->outputCache.addFile(output->fileName);
+        }
+    }
+}
+
+void ConversionPipeline::addToBatch(std::vector<Output> &batch,
+                                    Output output) {
+    if (output.variants.empty()) {
+        batch.push_back(std::move(output));
+        return;
+    }
+
+    // Parsing the shared part is printed along with the first profile
+    std::string messages = std::move(output.messages);
+
+    for (auto &variant : output.variants) {
+        batch.push_back(variant.get());
+        batch.back().messages.insert(0, messages);
+        messages.clear();
+    }
+
+    this->arenas.release(std::move(output.arena));
+}
+
+void ConversionPipeline::resolveDuplicate(Output &output) {
+    const auto original = this->writtenFiles.find(output.duplicateOf);
+    std::string directory = this->outputDirectory(output.file);
+
+    // Bases within another directory may differ
+    if (original != this->writtenFiles.end() &&
+            (!original->second.basesDirectory ||
+             *original->second.basesDirectory == directoryOf(output.name))) {
+        const WrittenFile &file = original->second;
+        output.fileName = directory + file.fileName.substr(file.directorySize);
+
+        for (const auto &companion : file.companions) {
+            output.companions.push_back({directory +
+                                         companion.substr(file.directorySize), {}});
+        }
+
+        // Copying a file onto itself would lose it, when it is overwritten
+        if (output.fileName != file.fileName) {
+            return;
+        }
+    }
+
+    const std::size_t sequence = output.sequence;
+    output.duplicate->messages = std::move(output.messages);
+    output = this->convert(*output.duplicate);
+    output.sequence = sequence;
+}
+
+void ConversionPipeline::copyDuplicate(const Output &output) {
+    const auto original = this->writtenFiles.find(output.duplicateOf);
+
+    // Writing the identical file failed or it has been overwritten within
+    // the same batch
+    if (original == this->writtenFiles.end()) {
+        Job job = *output.duplicate;
+        Output converted = this->convert(job);
+
+        if (converted.error) {
+            std::rethrow_exception(converted.error);
+        }
+
+        writeOutput({converted.fileName, converted.content});
+
+        for (const auto &companion : converted.companions) {
+            writeOutput({companion.fileName, companion.content});
+        }
+
+        this->arenas.release(std::move(converted.arena));
+        return;
+    }
+
+    OUTPUT << "Identical to " << original->second.fileName << ", copying it\n";
+    copyFile(original->second.fileName, output.fileName);
+
+    for (std::size_t i = 0; i < output.companions.size(); ++i) {
+        copyFile(original->second.companions[i], output.companions[i].fileName);
+    }
+
+    ++this->duplicates;
+}
+
+void ConversionPipeline::copyFile(const std::string &from,
+                                  const std::string &to) {
+#ifdef __linux__
+    // Shares the blocks on file systems like Btrfs and XFS
+    const int source = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (source >= 0) {
+        const int target = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                0666);
+        const bool cloned = target >= 0 && ioctl(target, FICLONE, source) == 0;
+
+        if (target >= 0) {
+            close(target);
+        }
+
+        close(source);
+
+        if (cloned) {
+            return;
+        }
+    }
+
+#endif
+    std::error_code error;
+    std::filesystem::copy_file(from, to,
+                               std::filesystem::copy_options::overwrite_existing, error);
+
+    if (error) {
+        throw exceptions::FailedToOpenFileException(to);
+    }
+}
+
+void ConversionPipeline::writeOutput(const utilities::OutputFile &file) {
+    // Batch files keep the line endings of the platform. Snapshots and the
+    // other scripts are written as is, a shell script must not get CRLF.
+    const bool isBatch = std::string_view(file.fileName).ends_with(
+                             getExtension(ScriptFormat::BAT));
+    std::ofstream outFile(file.fileName, isBatch ? std::ios::out
+                          : std::ios::out | std::ios::binary);
+
+    if (!outFile.good()) {
+        throw exceptions::FailedToOpenFileException(file.fileName);
+    }
+
+    outFile << file.content;
+}
+
+void ConversionPipeline::writeStandardOutput(const Output &output) {
+    // Only the first configuration may be the only one, the first profile
+    // tells if there are others
+    if (!this->framedStandardOutput) {
+        this->framedStandardOutput = output.sequence != 0 || output.hasMore;
+    }
+
+    if (*this->framedStandardOutput) {
+        std::cout << output.fileName << '\0' << output.content << '\0';
+    } else {
+        std::cout << output.content;
+    }
+
+    // The next program in the pipe can start with the file right away
+    std::cout.flush();
+
+    if (!std::cout.good()) {
+        throw exceptions::FailedToOpenFileException("standard output");
+    }
+}
+
+void ConversionPipeline::writeArchive(const Output &output) {
+    this->archive->add(output.fileName, output.content);
+
+    for (const auto &companion : output.companions) {
+        this->archive->add(companion.fileName, companion.content);
+    }
+}
+
+std::string ConversionPipeline::outputDirectory(std::size_t file) const {
+    return this->options.outputDirectory + this->files.subdirectory(file);
+}
+
+void ConversionPipeline::createSubdirectory(const Output &output) {
+    const std::string directory = this->outputDirectory(output.file);
+
+    if (directory == this->options.outputDirectory ||
+            !this->createdDirectories.insert(directory).second) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (error) {
+        throw exceptions::FailedToOpenFileException(directory);
+    }
+}
+
+bool ConversionPipeline::runForFile(const std::function<void()> &step,
+                                    const Output &output) {
+    try {
+        step();
+        return true;
+        // Only catch custom exceptions, other exceptions are fatal
+    } catch (const exceptions::CustomException &e) {
+        LOG_INFO << "Caught custom exception: " << typeid(e).name();
+        if (utilities::Utils::handleParseException(e, output.name,
+                output.hasMore)) {
+            return false;
+        }
+    } catch (const Json::Exception &e) {
+        LOG_INFO << "Caught Json exception: " << typeid(e).name();
+        if (utilities::Utils::handleParseException(e, output.name,
+                output.hasMore)) {
+            return false;
+        }
+    }
+
+    // The other stages have to be stopped before the application ends
+    this->stop();
+    exit(1);
+}
+} // namespace parsing
@@ -0,0 +1,343 @@
+/**
+ * @file DirectoryWalker.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-19
+ * @version 0.3.0
+ * @brief Implementation of the DirectoryWalker class.
+ *
+ * @see src/include/DirectoryWalker.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "DirectoryWalker.hpp"
+#include "FileSystemCache.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace utilities {
+namespace {
+/**
+ * @brief Returns the name of the last element of a path
+ */
+std::string_view fileName(std::string_view path) {
+    const std::size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+} // namespace
+
+DirectoryWalker::DirectoryWalker(Options options)
+    : ignoreFile(std::move(options.ignoreFile)) {
+    if (options.includes.empty()) {
+        options.includes.assign(std::begin(DEFAULT_INCLUDES),
+                                std::end(DEFAULT_INCLUDES));
+    }
+
+    for (const auto &include : options.includes) {
+        if (auto pattern = parsePattern(include)) {
+            this->includes.push_back(std::move(*pattern));
+        }
+    }
+
+    // The exclude patterns work like an ignore file within the root
+    auto excludeList = std::make_shared<IgnoreList>();
+
+    for (const auto &exclude : options.excludes) {
+        if (auto pattern = parsePattern(exclude)) {
+            excludeList->patterns.push_back(std::move(*pattern));
+        }
+    }
+
+    this->excludes = std::move(excludeList);
+}
+
+std::vector<WalkedFile> DirectoryWalker::walk(const std::string &directory)
+const {
+    LOG_INFO << "Searching directory " << directory;
+    const std::string root = directory.ends_with('/') ||
+                             directory.ends_with('\\') ? directory : directory + '/';
+    const unsigned threadCount = std::max(MIN_THREADS,
+                                          std::thread::hardware_concurrency());
+
+    // Directories are taken by the next free thread, the search is done,
+    // once no directory is left and no thread is reading one
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<Directory> pending{{"", this->excludes}};
+    unsigned busy = 0;
+    std::vector<std::vector<WalkedFile>> found(threadCount);
+
+    const auto worker = [&](std::vector<WalkedFile> &files) {
+        std::unique_lock lock(mutex);
+
+        while (true) {
+            changed.wait(lock, [&] {
+                return !pending.empty() || busy == 0;
+            });
+
+            if (pending.empty()) {
+                return;
+            }
+
+            const Directory current = std::move(pending.back());
+            pending.pop_back();
+            ++busy;
+            lock.unlock();
+
+            std::vector<Directory> directories;
+            this->readDirectory(root, current, directories, files);
+
+            lock.lock();
+            --busy;
+            std::ranges::move(directories, std::back_inserter(pending));
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker, std::ref(found[i]));
+    }
+
+    worker(found[0]);
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<WalkedFile> files;
+
+    for (auto &threadFiles : found) {
+        std::ranges::move(threadFiles, std::back_inserter(files));
+    }
+
+    std::ranges::sort(files, {}, &WalkedFile::path);
+    LOG_INFO << "Found " << files.size() << " files in " << directory;
+    return files;
+}
+
+void DirectoryWalker::readDirectory(const std::string &root,
+                                    const Directory &directory,
+                                    std::vector<Directory> &directories,
+                                    std::vector<WalkedFile> &files) const {
+    const std::string path = root + directory.relative;
+    std::shared_ptr<const IgnoreList> ignores = directory.ignores;
+
+    // The ignore file applies to this directory and everything below
+    if (this->ignoreFile) {
+        std::ifstream file(path + *this->ignoreFile);
+        std::string line;
+        auto list = std::make_shared<IgnoreList>();
+
+        while (std::getline(file, line)) {
+            if (auto pattern = parsePattern(line)) {
+                list->patterns.push_back(std::move(*pattern));
+            }
+        }
+
+        if (!list->patterns.empty()) {
+            list->parent = std::move(ignores);
+            list->base = directory.relative;
+            ignores = std::move(list);
+        }
+    }
+
+    const bool listed = FileSystemCache::listDirectory(path, [&](
+    std::string_view name, EntryType type) {
+        if (type == EntryType::OTHER) {
+            return;
+        }
+
+        std::string relative = directory.relative + std::string(name);
+        const bool isDirectory = type == EntryType::DIRECTORY;
+
+        if (isIgnored(ignores.get(), relative, isDirectory)) {
+            return;
+        }
+
+        if (isDirectory) {
+            directories.push_back({relative + '/', ignores});
+        } else if (std::ranges::any_of(this->includes, [&](const Pattern & include) {
+        return matches(include, relative);
+        })) {
+            files.push_back({root + relative, directory.relative});
+        }
+    });
+
+    if (!listed) {
+        LOG_WARNING << "Skipping directory \"" << path
+                    << "\", as it can't be read";
+    }
+}
+
+std::optional<DirectoryWalker::Pattern> DirectoryWalker::parsePattern(
+    std::string_view line) {
+    if (line.ends_with('\r')) {
+        line.remove_suffix(1);
+    }
+
+    // Trailing spaces are ignored, unless they are escaped
+    while (line.ends_with(' ') && !line.ends_with("\\ ")) {
+        line.remove_suffix(1);
+    }
+
+    if (line.empty() || line.starts_with('#')) {
+        return std::nullopt;
+    }
+
+    Pattern pattern;
+    pattern.negated = line.starts_with('!');
+
+    if (pattern.negated) {
+        line.remove_prefix(1);
+    }
+
+    pattern.directoryOnly = line.ends_with('/');
+
+    while (line.ends_with('/')) {
+        line.remove_suffix(1);
+    }
+
+    pattern.anchored = line.find('/') != std::string_view::npos;
+
+    if (line.starts_with('/')) {
+        line.remove_prefix(1);
+    }
+
+    if (line.empty()) {
+        return std::nullopt;
+    }
+
+    pattern.glob = line;
+    return pattern;
+}
+
+bool DirectoryWalker::matches(const Pattern &pattern,
+                              std::string_view relative) {
+    return matchGlob(pattern.glob,
+                     pattern.anchored ? relative : fileName(relative));
+}
+
+bool DirectoryWalker::isIgnored(const IgnoreList *ignores,
+                                std::string_view relative, bool isDirectory) {
+    // The lists closer to the entry take precedence
+    std::vector<const IgnoreList *> lists;
+
+    for (; ignores != nullptr; ignores = ignores->parent.get()) {
+        lists.push_back(ignores);
+    }
+
+    bool ignored = false;
+
+    for (auto list = lists.rbegin(); list != lists.rend(); ++list) {
+        const std::string_view path = relative.substr((*list)->base.size());
+
+        // The last matching pattern decides
+        for (const auto &pattern : (*list)->patterns) {
+            if ((!pattern.directoryOnly || isDirectory) && matches(pattern, path)) {
+                ignored = !pattern.negated;
+            }
+        }
+    }
+
+    return ignored;
+}
+
+bool DirectoryWalker::matchGlob(std::string_view pattern,
+                                std::string_view path) {
+    while (!pattern.empty()) {
+        if (pattern.starts_with("**")) {
+            std::string_view rest = pattern.substr(2);
+
+            // "**/" may also match no directory at all
+            if (rest.starts_with('/') && matchGlob(rest.substr(1), path)) {
+                return true;
+            }
+
+            for (std::size_t i = 0; i <= path.size(); ++i) {
+                if (matchGlob(rest, path.substr(i))) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        if (pattern.front() == '*') {
+            const std::string_view rest = pattern.substr(1);
+
+            // A single star stays within the directory
+            for (std::size_t i = 0; i <= path.size(); ++i) {
+                if (matchGlob(rest, path.substr(i))) {
+                    return true;
+                }
+
+                if (i < path.size() && path[i] == '/') {
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        if (path.empty()) {
+            return false;
+        }
+
+        const char c = path.front();
+
+        if (pattern.front() == '?') {
+            if (c == '/') {
+                return false;
+            }
+
+            pattern.remove_prefix(1);
+        } else if (const std::size_t close = pattern.find(']',
+                                             pattern.size() > 2 && (pattern[1] == '!' || pattern[1] == '^') ? 3 : 2);
+                   pattern.front() == '[' && close != std::string_view::npos) {
+            const bool negated = pattern[1] == '!' || pattern[1] == '^';
+            const std::string_view set = pattern.substr(negated ? 2 : 1,
+                                         close - (negated ? 2 : 1));
+            bool inSet = false;
+
+            for (std::size_t i = 0; i < set.size(); ++i) {
+                if (i + 2 < set.size() && set[i + 1] == '-') {
+                    inSet = inSet || (set[i] <= c && c <= set[i + 2]);
+                    i += 2;
+                } else {
+                    inSet = inSet || set[i] == c;
+                }
+            }
+
+            if (inSet == negated || c == '/') {
+                return false;
+            }
+
+            pattern.remove_prefix(close + 1);
+        } else {
+            // An escaped character is always literal
+            if (pattern.front() == '\\' && pattern.size() > 1) {
+                pattern.remove_prefix(1);
+            }
+
+            if (pattern.front() != c) {
+                return false;
+            }
+
+            pattern.remove_prefix(1);
+        }
+
+        path.remove_prefix(1);
+    }
+
+    return path.empty();
+}
+} // namespace utilities
@@ -14,8 +14,10 @@
 #include "Exceptions.hpp"
 #include "LoggingWrapper.hpp"
 
+#include <stdexcept>
+
 namespace parsing {
-void FileData::setOutputFile(std::string &newOutputfile) {
+void FileData::setOutputFile(std::string_view newOutputfile) {
     LOG_INFO << "Setting outputfile to...";
 
     // If no value for key "outputfile"
@@ -26,34 +28,36 @@ void FileData::setOutputFile(std::string &newOutputfile) {
     }
 
     // If outputfile is already set
-    if (!this->outputfile.empty()) {
+    if (this->outputfile.length != 0) {
         LOG_INFO << "Escalating error to ErrorHandler::invalidValue!";
         throw exceptions::InvalidValueException("outputfile",
                                                 "Outputfile is already set!");
     }
 
+    this->outputfile = this->append(newOutputfile);
+
     // If outputfile does not end with ".bat"
     if (!newOutputfile.ends_with(".bat")) {
-        newOutputfile += ".bat";
+        // Directly follows the outputfile within the blob
+        this->outputfile.length += this->append(".bat").length;
         LOG_WARNING << "Outputfile does not end with \".bat\", adding it now: "
-                    << newOutputfile;
+                    << this->getOutputFile();
     }
 
-    this->outputfile = newOutputfile;
-    LOG_INFO << "Outputfile set to: " << this->outputfile << "\n";
+    LOG_INFO << "Outputfile set to: " << this->getOutputFile() << "\n";
 }
 
-void FileData::setApplication(const std::string &newApplication) {
+void FileData::setApplication(std::string_view newApplication) {
     if (newApplication.empty()) {
         LOG_INFO << "newApplication empty, returning";
         return;
     }
 
     LOG_INFO << "Setting application to: " << newApplication << "\n";
-    this->application.emplace(newApplication);
+    this->application = this->store(newApplication);
 }
 
-void FileData::addCommand(const std::string &command) {
+void FileData::addCommand(std::string_view command) {
     if (command.empty()) {
         LOG_INFO << "Escalating error to ErrorHandler::invalidValue!";
         throw exceptions::InvalidValueException("command",
@@ -61,11 +65,11 @@ void FileData::addCommand(const std::string &command) {
     }
 
     LOG_INFO << "Adding command: " << command << "\n";
-    this->commands.push_back(command);
+    this->commands.push_back(this->store(command));
 }
 
-void FileData::addEnvironmentVariable(const std::string &name,
-                                      const std::string &value) {
+void FileData::addEnvironmentVariable(std::string_view name,
+                                      std::string_view value) {
     if (name.empty()) {
         LOG_INFO << "Escalating error to ErrorHandler::invalidValue!";
         throw exceptions::InvalidValueException("name", "Name value is empty!");
@@ -77,16 +81,98 @@ void FileData::addEnvironmentVariable(const std::string &name,
     }
 
     LOG_INFO << "Adding environment variable: " << name << "=" << value << "\n";
-    this->environmentVariables.emplace_back(name, value);
+    this->environmentKeys.push_back(this->store(name));
+    this->environmentValues.push_back(this->store(value));
 }
 
-void FileData::addPathValue(const std::string &pathValue) {
+void FileData::addPathValue(std::string_view pathValue) {
     if (pathValue.empty()) {
         LOG_INFO << "Escalating error to ErrorHandler::invalidValue!";
         throw exceptions::InvalidValueException("path", "Path value is empty");
     }
 
     LOG_INFO << "Adding path value: " << pathValue << "\n";
-    this->pathValues.push_back(pathValue);
+    this->pathValues.push_back(this->store(pathValue));
+}
+
+void FileData::extend(const FileData &base) {
+    LOG_INFO << "Adding the values of a base configuration\n";
+    this->hideShell = base.hideShell;
+
+    // Interned values are shared with the base, the others are copied
+    const auto copyValue = [this, &base](Span span) {
+        if (span.isInterned()) {
+            this->internedSize += span.length;
+            return span;
+        }
+
+        return this->append(base.view(span));
+    };
+
+    if (base.application.has_value()) {
+        this->application = copyValue(base.application.value());
+    }
+
+    // The values are already validated within the base
+    const auto copy = [&copyValue](std::pmr::vector<Span> &spans,
+    const std::pmr::vector<Span> &baseSpans) {
+        spans.reserve(spans.size() + baseSpans.size());
+
+        for (const Span span : baseSpans) {
+            spans.push_back(copyValue(span));
+        }
+    };
+
+    copy(this->commands, base.commands);
+    copy(this->environmentKeys, base.environmentKeys);
+    copy(this->environmentValues, base.environmentValues);
+    copy(this->pathValues, base.pathValues);
+}
+
+void FileData::concatenate(const FileData &fragment) {
+    if (this->blob.size() + fragment.blob.size() > Span::INTERNED) {
+        throw std::length_error("FileData exceeds 2 GiB");
+    }
+
+    // The blob of the fragment is moved behind the own one as a whole
+    const auto offset = static_cast<std::uint32_t>(this->blob.size());
+    this->blob.append(fragment.blob);
+    this->internedSize += fragment.internedSize;
+    const auto copy = [offset](std::pmr::vector<Span> &spans,
+    const std::pmr::vector<Span> &fragmentSpans) {
+        spans.reserve(spans.size() + fragmentSpans.size());
+
+        for (const Span span : fragmentSpans) {
+            spans.push_back(span.isInterned() ? span :
+                            Span{span.offset + offset, span.length});
+        }
+    };
+
+    copy(this->commands, fragment.commands);
+    copy(this->environmentKeys, fragment.environmentKeys);
+    copy(this->environmentValues, fragment.environmentValues);
+    copy(this->pathValues, fragment.pathValues);
+}
+
+Span FileData::append(std::string_view value) {
+    // Spans are kept small, as there are a lot of them. The highest bit of
+    // the offset marks interned values.
+    if (this->blob.size() + value.size() > Span::INTERNED) {
+        throw std::length_error("FileData exceeds 2 GiB");
+    }
+
+    const Span span{static_cast<std::uint32_t>(this->blob.size()),
+                    static_cast<std::uint32_t>(value.size())};
+    this->blob.append(value);
+    return span;
+}
+
+Span FileData::store(std::string_view value) {
+    if (const auto index = InternTable::getInstance().intern(value)) {
+        this->internedSize += value.size();
+        return {*index | Span::INTERNED, static_cast<std::uint32_t>(value.size())};
+    }
+
+    return this->append(value);
 }
 } // namespace parsing
@@ -0,0 +1,159 @@
+/**
+ * @file FileList.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-20
+ * @version 0.3.0
+ * @brief Implementation of the FileList class.
+ *
+ * @see src/include/FileList.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "FileList.hpp"
+#include "Exceptions.hpp"
+#include "InputFile.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <fstream>
+#include <optional>
+#include <utility>
+
+namespace utilities {
+void FileList::add(std::string file, std::string subdirectory) {
+    {
+        const std::lock_guard lock(this->mutex);
+        this->entries.push_back({std::move(file), std::move(subdirectory)});
+    }
+
+    this->changed.notify_all();
+}
+
+void FileList::addFromList(const std::string &listFile) {
+    LOG_INFO << "Reading the list of files " << listFile;
+    const bool isStandardInput = listFile == "-";
+    std::ifstream file;
+
+    if (!isStandardInput) {
+        file.open(listFile, std::ios::binary);
+
+        if (!file.good()) {
+            throw exceptions::FailedToOpenFileException(listFile);
+        }
+    }
+
+    std::string buffer;
+    std::optional<char> separator;
+    std::size_t count = 0;
+
+    // The last name may be incomplete, until the next chunk has been read
+    while (true) {
+        const std::size_t previousSize = buffer.size();
+        buffer.resize(previousSize + CHUNK_SIZE);
+        std::size_t length = 0;
+
+        if (isStandardInput) {
+            length = InputFile::readStandardInput(buffer.data() + previousSize,
+                                                  CHUNK_SIZE);
+        } else {
+            file.read(buffer.data() + previousSize,
+                      static_cast<std::streamsize>(CHUNK_SIZE));
+            length = static_cast<std::size_t>(file.gcount());
+        }
+
+        buffer.resize(previousSize + length);
+        const bool atEnd = length == 0;
+
+        // Decided by the first separator, as names may contain either
+        if (const std::size_t first = buffer.find_first_of(std::string_view("\0\n", 2));
+                !separator && first != std::string::npos) {
+            separator = buffer[first];
+        }
+
+        std::size_t start = 0;
+
+        for (std::size_t end = separator ? buffer.find(*separator) : std::string::npos;
+                end != std::string::npos; end = buffer.find(*separator, start)) {
+            std::string_view name(buffer.data() + start, end - start);
+            start = end + 1;
+
+            if (*separator == '\n' && name.ends_with('\r')) {
+                name.remove_suffix(1);
+            }
+
+            if (!name.empty()) {
+                this->add(std::string(name));
+                ++count;
+            }
+        }
+
+        buffer.erase(0, start);
+
+        if (atEnd) {
+            break;
+        }
+    }
+
+    // The last name doesn't need a separator
+    if (separator != '\0' && buffer.ends_with('\r')) {
+        buffer.pop_back();
+    }
+
+    if (!buffer.empty()) {
+        this->add(std::move(buffer));
+        ++count;
+    }
+
+    LOG_INFO << "Added " << count << " files from " << listFile;
+}
+
+void FileList::close() {
+    {
+        const std::lock_guard lock(this->mutex);
+        this->closed = true;
+    }
+
+    this->changed.notify_all();
+}
+
+bool FileList::wait(std::size_t index) const {
+    std::unique_lock lock(this->mutex);
+    this->changed.wait(lock, [&] {
+        return this->closed || index < this->entries.size();
+    });
+    return index < this->entries.size();
+}
+
+std::vector<std::string> FileList::available(std::size_t index,
+        std::size_t maxCount) const {
+    const std::lock_guard lock(this->mutex);
+    std::vector<std::string> files;
+
+    for (std::size_t i = index;
+            i < this->entries.size() && files.size() < maxCount; ++i) {
+        files.push_back(this->entries[i].file);
+    }
+
+    return files;
+}
+
+const std::string &FileList::operator[](std::size_t index) const {
+    const std::lock_guard lock(this->mutex);
+    return this->entries[index].file;
+}
+
+const std::string &FileList::subdirectory(std::size_t index) const {
+    const std::lock_guard lock(this->mutex);
+    return this->entries[index].subdirectory;
+}
+
+bool FileList::isLast(std::size_t index) const {
+    const std::lock_guard lock(this->mutex);
+    return this->closed && index + 1 == this->entries.size();
+}
+
+std::size_t FileList::size() const {
+    const std::lock_guard lock(this->mutex);
+    return this->entries.size();
+}
+} // namespace utilities
@@ -0,0 +1,192 @@
+/**
+ * @file FileSystemCache.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-21
+ * @version 0.3.0
+ * @brief Implementation of the FileSystemCache class.
+ *
+ * @see src/include/FileSystemCache.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "FileSystemCache.hpp"
+#include "LoggingWrapper.hpp"
+
+#ifdef IS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <filesystem>
+#endif
+
+namespace utilities {
+FileStatus FileSystemCache::stat(const std::string &path) {
+    FileStatus status;
+#if defined(IS_UNIX) && defined(__linux__)
+    // Only the requested fields have to be retrieved
+    struct statx result {};
+
+    if (statx(AT_FDCWD, path.c_str(), 0, STATX_TYPE | STATX_SIZE,
+              &result) == 0) {
+        status.exists = true;
+        status.isRegularFile = S_ISREG(result.stx_mode);
+        status.isDirectory = S_ISDIR(result.stx_mode);
+        status.size = result.stx_size;
+    }
+
+#elif defined(IS_UNIX)
+    struct stat result {};
+
+    if (::stat(path.c_str(), &result) == 0) {
+        status.exists = true;
+        status.isRegularFile = S_ISREG(result.st_mode);
+        status.isDirectory = S_ISDIR(result.st_mode);
+        status.size = static_cast<std::uint64_t>(result.st_size);
+    }
+
+#else
+    std::error_code error;
+    const auto fileStatus = std::filesystem::status(path, error);
+
+    if (!error && std::filesystem::exists(fileStatus)) {
+        status.exists = true;
+        status.isRegularFile = std::filesystem::is_regular_file(fileStatus);
+        status.isDirectory = std::filesystem::is_directory(fileStatus);
+
+        if (status.isRegularFile) {
+            status.size = std::filesystem::file_size(path, error);
+        }
+    }
+
+#endif
+    return status;
+}
+
+bool FileSystemCache::listDirectory(const std::string &path,
+                                    const std::function<void(std::string_view, EntryType)> &entry) {
+#ifdef IS_UNIX
+    // readdir() reads the entries in large blocks using getdents() and
+    // already knows their type on most file systems
+    DIR *directory = opendir(path.empty() ? "." : path.c_str());
+
+    if (directory == nullptr) {
+        return false;
+    }
+
+    while (const dirent *current = readdir(directory)) {
+        const std::string_view name = current->d_name;
+
+        if (name == "." || name == "..") {
+            continue;
+        }
+
+        EntryType type = EntryType::OTHER;
+
+        if (current->d_type == DT_REG) {
+            type = EntryType::FILE;
+        } else if (current->d_type == DT_DIR) {
+            type = EntryType::DIRECTORY;
+        } else if (current->d_type == DT_LNK || current->d_type == DT_UNKNOWN) {
+            // Links are only followed to files, to avoid cycles
+            struct stat status {};
+            const std::string entryPath = path + std::string(name);
+
+            if (current->d_type == DT_LNK
+                    ? ::stat(entryPath.c_str(), &status) == 0 && S_ISREG(status.st_mode)
+                    : lstat(entryPath.c_str(), &status) == 0) {
+                type = S_ISREG(status.st_mode) ? EntryType::FILE
+                       : S_ISDIR(status.st_mode) ? EntryType::DIRECTORY
+                       : EntryType::OTHER;
+            }
+        }
+
+        entry(name, type);
+    }
+
+    closedir(directory);
+    return true;
+#else
+    std::error_code error;
+    std::filesystem::directory_iterator iterator(path.empty() ? "." : path,
+            error);
+
+    if (error) {
+        return false;
+    }
+
+    for (const auto &current : iterator) {
+        const std::string name = current.path().filename().string();
+        EntryType type = EntryType::OTHER;
+
+        if (current.is_regular_file(error)) {
+            type = EntryType::FILE;
+        } else if (current.is_directory(error) && !current.is_symlink(error)) {
+            type = EntryType::DIRECTORY;
+        }
+
+        entry(name, type);
+    }
+
+    return true;
+#endif
+}
+
+bool FileSystemCache::isRegularFile(const std::string &path) {
+#ifdef __linux__
+    const auto [directory, name] = split(path);
+    return this->listing(directory).contains(std::string(name));
+#else
+    return stat(path).isRegularFile;
+#endif
+}
+
+void FileSystemCache::addFile(const std::string &path) {
+#ifdef __linux__
+    const auto [directory, name] = split(path);
+
+    // A directory, which hasn't been listed yet, will be listed completely
+    if (const auto listed = this->listings.find(directory);
+            listed != this->listings.end()) {
+        listed->second.emplace(name);
+    }
+
+#else
+    (void)path;
+#endif
+}
+
+std::pair<std::string, std::string_view> FileSystemCache::split(
+    std::string_view path) {
+    const std::size_t separator = path.find_last_of("/\\");
+
+    if (separator == std::string_view::npos) {
+        return {"", path};
+    }
+
+    return {std::string(path.substr(0, separator + 1)),
+            path.substr(separator + 1)};
+}
+
+std::unordered_set<std::string> &FileSystemCache::listing(
+    const std::string &directory) {
+    if (const auto listed = this->listings.find(directory);
+            listed != this->listings.end()) {
+        return listed->second;
+    }
+
+    std::unordered_set<std::string> files;
+
+    // A directory, which doesn't exist yet, doesn't contain any files
+    listDirectory(directory, [&](std::string_view name, EntryType type) {
+        if (type == EntryType::FILE) {
+            files.emplace(name);
+        }
+    });
+
+    LOG_INFO << "Listed " << files.size() << " files in directory \""
+             << (directory.empty() ? "." : directory) << "\"";
+    return this->listings.emplace(directory, std::move(files)).first->second;
+}
+} // namespace utilities
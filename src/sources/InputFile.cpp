@@ -0,0 +1,229 @@
+/**
+ * @file InputFile.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-06
+ * @version 0.3.0
+ * @brief Implementation of the InputFile class.
+ *
+ * @see src/include/InputFile.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "InputFile.hpp"
+#include "Exceptions.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <cerrno>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef IS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <io.h>
+#endif
+
+namespace utilities {
+namespace {
+/**
+ * @brief Maximum number of buffers kept within the pool
+ */
+constexpr std::size_t MAX_POOLED_BUFFERS = 8;
+
+/**
+ * @brief Pool of buffers with MMAP_THRESHOLD bytes each
+ * @details
+ * Shared by all threads, as the files are read on one thread and released
+ * on the threads converting them.
+ */
+std::mutex bufferPoolMutex;
+std::vector<std::unique_ptr<char[]>> bufferPool;
+} // namespace
+
+char *InputFile::acquireBuffer(std::size_t size) {
+    if (size > MMAP_THRESHOLD) {
+        LOG_INFO << "Allocating dedicated buffer of " << size << " bytes";
+        this->buffer = std::unique_ptr<char[]>(new char[size]);
+        this->bufferCapacity = size;
+        return this->buffer.get();
+    }
+
+    {
+        std::scoped_lock lock(bufferPoolMutex);
+
+        if (!bufferPool.empty()) {
+            this->buffer = std::move(bufferPool.back());
+            bufferPool.pop_back();
+        }
+    }
+
+    if (!this->buffer) {
+        this->buffer = std::unique_ptr<char[]>(new char[MMAP_THRESHOLD]);
+    }
+
+    this->bufferCapacity = MMAP_THRESHOLD;
+    return this->buffer.get();
+}
+
+InputFile InputFile::allocate(std::size_t size) {
+    InputFile inputFile;
+    inputFile.data = inputFile.acquireBuffer(size);
+    inputFile.length = size;
+    return inputFile;
+}
+
+std::size_t InputFile::readStandardInput(char *buffer, std::size_t size) {
+#ifdef IS_UNIX
+
+    while (true) {
+        const ssize_t count = read(STDIN_FILENO, buffer, size);
+
+        if (count >= 0) {
+            return static_cast<std::size_t>(count);
+        }
+
+        if (errno != EINTR) {
+            throw exceptions::FailedToOpenFileException("standard input");
+        }
+    }
+
+#else
+    // _read() returns partial reads of pipes as well, unlike std::fread()
+    const int count = _read(0, buffer, static_cast<unsigned>(size));
+
+    if (count < 0) {
+        throw exceptions::FailedToOpenFileException("standard input");
+    }
+
+    return static_cast<std::size_t>(count);
+#endif
+}
+
+InputFile::InputFile(InputFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      length(std::exchange(other.length, 0)),
+      mapped(std::exchange(other.mapped, false)),
+      buffer(std::move(other.buffer)),
+      bufferCapacity(std::exchange(other.bufferCapacity, 0)) {}
+
+InputFile &InputFile::operator=(InputFile &&other) noexcept {
+    if (this != &other) {
+        this->release();
+        this->data = std::exchange(other.data, nullptr);
+        this->length = std::exchange(other.length, 0);
+        this->mapped = std::exchange(other.mapped, false);
+        this->buffer = std::move(other.buffer);
+        this->bufferCapacity = std::exchange(other.bufferCapacity, 0);
+    }
+
+    return *this;
+}
+
+InputFile::~InputFile() {
+    this->release();
+}
+
+void InputFile::release() {
+#ifdef IS_UNIX
+    if (this->mapped) {
+        munmap(const_cast<char *>(this->data), this->length);
+        this->mapped = false;
+        return;
+    }
+#endif
+
+    // Only buffers of the pooled size are returned
+    if (this->buffer && this->bufferCapacity == MMAP_THRESHOLD) {
+        std::scoped_lock lock(bufferPoolMutex);
+
+        if (bufferPool.size() < MAX_POOLED_BUFFERS) {
+            bufferPool.push_back(std::move(this->buffer));
+        }
+    }
+}
+
+#ifdef IS_UNIX
+InputFile::InputFile(const std::string &filename) {
+    LOG_INFO << "Loading file: " << filename;
+    const int fileDescriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fileDescriptor == -1) {
+        throw exceptions::FailedToOpenFileException(filename);
+    }
+
+    struct stat fileStat = {};
+
+    if (fstat(fileDescriptor, &fileStat) == -1) {
+        close(fileDescriptor);
+        throw exceptions::FailedToOpenFileException(filename);
+    }
+
+    this->length = static_cast<std::size_t>(fileStat.st_size);
+
+    if (this->length >= MMAP_THRESHOLD) {
+        void *mapping = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE,
+                             fileDescriptor, 0);
+
+        if (mapping != MAP_FAILED) {
+            // The file is only read once from front to back
+            madvise(mapping, this->length, MADV_SEQUENTIAL);
+            close(fileDescriptor);
+            this->data = static_cast<const char *>(mapping);
+            this->mapped = true;
+            LOG_INFO << "Mapped " << this->length << " bytes";
+            return;
+        }
+
+        LOG_INFO << "Failed to map file, falling back to read()";
+    }
+
+    char *target = this->acquireBuffer(this->length);
+    std::size_t total = 0;
+
+    // read() may return less than requested, so loop until the end
+    while (total < this->length) {
+        const ssize_t count =
+            read(fileDescriptor, target + total, this->length - total);
+
+        if (count == -1) {
+            close(fileDescriptor);
+            throw exceptions::FailedToOpenFileException(filename);
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        total += static_cast<std::size_t>(count);
+    }
+
+    close(fileDescriptor);
+    this->data = target;
+    this->length = total;
+    LOG_INFO << "Read " << this->length << " bytes";
+}
+#else
+InputFile::InputFile(const std::string &filename) {
+    LOG_INFO << "Loading file: " << filename;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open()) {
+        throw exceptions::FailedToOpenFileException(filename);
+    }
+
+    this->length = static_cast<std::size_t>(file.tellg());
+    file.seekg(0);
+    char *target = this->acquireBuffer(this->length);
+    file.read(target, static_cast<std::streamsize>(this->length));
+    this->data = target;
+    this->length = static_cast<std::size_t>(file.gcount());
+    LOG_INFO << "Read " << this->length << " bytes";
+}
+#endif
+} // namespace utilities
@@ -0,0 +1,100 @@
+/**
+ * @file InternTable.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-27
+ * @version 0.3.0
+ * @brief Implementation of the InternTable class.
+ *
+ * @see src/include/InternTable.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "InternTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace parsing {
+InternTable &InternTable::getInstance() {
+    static InternTable internTable;
+    return internTable;
+}
+
+std::optional<std::uint32_t> InternTable::intern(std::string_view value) {
+    if (value.size() < MIN_SIZE) {
+        return std::nullopt;
+    }
+
+    Shard &shard =
+        this->shards[std::hash<std::string_view> {}(value) % SHARDS];
+    std::scoped_lock lock(shard.mutex);
+
+    if (const auto found = shard.indices.find(value);
+            found != shard.indices.end()) {
+        this->reused.fetch_add(1, std::memory_order_relaxed);
+        return found->second;
+    }
+
+    // Once full, the values are stored within the blobs of the files
+    if (this->bytes.load(std::memory_order_relaxed) + value.size() > MAX_BYTES ||
+            this->count.load(std::memory_order_relaxed) >= MAX_ENTRIES) {
+        return std::nullopt;
+    }
+
+    const std::uint32_t index = this->count.fetch_add(1);
+
+    if (index >= MAX_ENTRIES) {
+        return std::nullopt;
+    }
+
+    this->bytes.fetch_add(value.size(), std::memory_order_relaxed);
+    const std::string_view stored = store(shard, value);
+    // Written before the index is handed out, by the shard or the caller
+    this->block(index / BLOCK_SIZE)[index % BLOCK_SIZE] = stored;
+    shard.indices.emplace(stored, index);
+    return index;
+}
+
+InternTable::Statistics InternTable::getStatistics() const {
+    return {.values = std::min<std::uint64_t>(this->count.load(), MAX_ENTRIES),
+            .bytes = this->bytes.load(), .reused = this->reused.load()};
+}
+
+std::string_view InternTable::store(Shard &shard, std::string_view value) {
+    if (shard.freeSize < value.size()) {
+        const std::size_t size = std::max(CHUNK_SIZE, value.size());
+        shard.chunks.push_back(std::unique_ptr<char[]>(new char[size]));
+        shard.free = shard.chunks.back().get();
+        shard.freeSize = size;
+    }
+
+    std::memcpy(shard.free, value.data(), value.size());
+    const std::string_view stored(shard.free, value.size());
+    shard.free += value.size();
+    shard.freeSize -= value.size();
+    return stored;
+}
+
+std::string_view *InternTable::block(std::size_t block) {
+    std::string_view *values =
+        this->blocks[block].load(std::memory_order_acquire);
+
+    if (values != nullptr) {
+        return values;
+    }
+
+    std::scoped_lock lock(this->blocksMutex);
+    values = this->blocks[block].load(std::memory_order_acquire);
+
+    if (values == nullptr) {
+        this->ownedBlocks.push_back(std::make_unique<std::string_view[]>
+                                    (BLOCK_SIZE));
+        values = this->ownedBlocks.back().get();
+        this->blocks[block].store(values, std::memory_order_release);
+    }
+
+    return values;
+}
+} // namespace parsing
@@ -0,0 +1,432 @@
+/**
+ * @file IoUring.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-08
+ * @version 0.3.0
+ * @brief Implementation of the IoUring class.
+ * @details
+ * The ring is set up using the raw syscalls and the definitions from the
+ * kernel header, so that no further library is needed.
+ *
+ * @see src/include/IoUring.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "IoUring.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <stdexcept>
+
+#ifdef HAS_IO_URING
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace utilities {
+namespace {
+/**
+ * @brief Size of the submission queue
+ * @details
+ * Reading and writing need two entries per file (read/write and close).
+ */
+constexpr unsigned RING_ENTRIES = 2 * IoUring::BATCH_SIZE;
+
+/**
+ * @brief Operations, which have to be supported by the kernel
+ */
+constexpr std::uint8_t NEEDED_OPERATIONS[] = {
+    IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE,
+    IORING_OP_CLOSE
+};
+
+/**
+ * @brief Mode for newly created output files (same as std::ofstream)
+ */
+constexpr unsigned OUTPUT_MODE = 0666;
+
+template <typename T> T *atOffset(void *base, unsigned offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+std::uint64_t toAddress(const void *pointer) {
+    return reinterpret_cast<std::uintptr_t>(pointer);
+}
+} // namespace
+
+bool IoUring::isAvailable() {
+    static const bool available = [] {
+        try {
+            const IoUring ring;
+            return true;
+        } catch (const std::runtime_error &e) {
+            LOG_INFO << "io_uring is not available: " << e.what();
+            return false;
+        }
+    }();
+    return available;
+}
+
+IoUring::IoUring() {
+    io_uring_params params = {};
+    this->ringFd = static_cast<int>(
+                       syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+
+    if (this->ringFd < 0) {
+        throw std::runtime_error("io_uring_setup failed");
+    }
+
+    this->entries = params.sq_entries;
+    this->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    this->cqRingSize =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    // Newer kernels allow to map both rings at once
+    const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+    if (singleMap) {
+        this->sqRingSize = std::max(this->sqRingSize, this->cqRingSize);
+        this->cqRingSize = 0;
+    }
+
+    this->sqRing = mmap(nullptr, this->sqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, this->ringFd,
+                        IORING_OFF_SQ_RING);
+    this->cqRing = singleMap
+                   ? this->sqRing
+                   : mmap(nullptr, this->cqRingSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, this->ringFd,
+                          IORING_OFF_CQ_RING);
+    this->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqesMapping = mmap(nullptr, this->sqesSize, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, this->ringFd,
+                             IORING_OFF_SQES);
+
+    if (this->sqRing == MAP_FAILED || this->cqRing == MAP_FAILED ||
+            sqesMapping == MAP_FAILED) {
+        this->sqRing = this->sqRing == MAP_FAILED ? nullptr : this->sqRing;
+        this->cqRing = this->cqRing == MAP_FAILED ? nullptr : this->cqRing;
+        this->sqes = sqesMapping == MAP_FAILED
+                     ? nullptr
+                     : static_cast<io_uring_sqe *>(sqesMapping);
+        this->teardown();
+        throw std::runtime_error("Failed to map the io_uring queues");
+    }
+
+    this->sqes = static_cast<io_uring_sqe *>(sqesMapping);
+    this->sqTail = atOffset<unsigned>(this->sqRing, params.sq_off.tail);
+    this->sqMask = atOffset<unsigned>(this->sqRing, params.sq_off.ring_mask);
+    this->sqArray = atOffset<unsigned>(this->sqRing, params.sq_off.array);
+    this->cqHead = atOffset<unsigned>(this->cqRing, params.cq_off.head);
+    this->cqTail = atOffset<unsigned>(this->cqRing, params.cq_off.tail);
+    this->cqMask = atOffset<unsigned>(this->cqRing, params.cq_off.ring_mask);
+    this->cqes = atOffset<io_uring_cqe>(this->cqRing, params.cq_off.cqes);
+
+    // Make sure the kernel supports all operations which are used
+    constexpr unsigned probeOperations = 256;
+    const auto probeBuffer = std::make_unique<std::byte[]>(
+                                 sizeof(io_uring_probe) +
+                                 probeOperations * sizeof(io_uring_probe_op));
+    auto *probe = reinterpret_cast<io_uring_probe *>(probeBuffer.get());
+
+    if (syscall(__NR_io_uring_register, this->ringFd, IORING_REGISTER_PROBE,
+                probe, probeOperations) < 0) {
+        this->teardown();
+        throw std::runtime_error("io_uring probe failed");
+    }
+
+    for (const auto operation : NEEDED_OPERATIONS) {
+        if (operation > probe->last_op ||
+                (probe->ops[operation].flags & IO_URING_OP_SUPPORTED) == 0) {
+            this->teardown();
+            throw std::runtime_error("io_uring operation not supported");
+        }
+    }
+
+    LOG_INFO << "io_uring has been set up with " << this->entries
+             << " entries";
+}
+
+IoUring::~IoUring() {
+    this->teardown();
+}
+
+void IoUring::teardown() {
+    if (this->sqes != nullptr) {
+        munmap(this->sqes, this->sqesSize);
+        this->sqes = nullptr;
+    }
+
+    if (this->cqRing != nullptr && this->cqRing != this->sqRing) {
+        munmap(this->cqRing, this->cqRingSize);
+    }
+
+    if (this->sqRing != nullptr) {
+        munmap(this->sqRing, this->sqRingSize);
+    }
+
+    this->sqRing = nullptr;
+    this->cqRing = nullptr;
+
+    if (this->ringFd >= 0) {
+        close(this->ringFd);
+        this->ringFd = -1;
+    }
+}
+
+io_uring_sqe *IoUring::queue(std::uint64_t userData) {
+    if (this->queued == this->entries) {
+        throw std::runtime_error("io_uring submission queue is full");
+    }
+
+    // Only this thread writes the tail, so the kernel can't change it
+    const unsigned tail =
+        std::atomic_ref(*this->sqTail).load(std::memory_order_relaxed);
+    const unsigned index = (tail + this->queued) & *this->sqMask;
+    io_uring_sqe *sqe = &this->sqes[index];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->user_data = userData;
+    this->sqArray[index] = index;
+    ++this->queued;
+    return sqe;
+}
+
+template <typename Callback>
+void IoUring::submitAndWait(Callback &&onCompletion) {
+    // The entries have to be visible before the kernel sees the new tail
+    std::atomic_ref tail(*this->sqTail);
+    tail.store(tail.load(std::memory_order_relaxed) + this->queued,
+               std::memory_order_release);
+    // Every queued entry produces exactly one completion
+    unsigned toSubmit = this->queued;
+    unsigned remaining = this->queued;
+    this->queued = 0;
+
+    while (remaining > 0) {
+        const auto submitted = syscall(__NR_io_uring_enter, this->ringFd, toSubmit,
+                                       1U, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+        if (submitted < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw std::runtime_error("io_uring_enter failed");
+        }
+
+        toSubmit -= static_cast<unsigned>(submitted);
+        std::atomic_ref head(*this->cqHead);
+        unsigned current = head.load(std::memory_order_relaxed);
+        const unsigned end =
+            std::atomic_ref(*this->cqTail).load(std::memory_order_acquire);
+
+        for (; current != end; ++current, --remaining) {
+            const io_uring_cqe &cqe = this->cqes[current & *this->cqMask];
+            onCompletion(cqe.user_data, cqe.res);
+        }
+
+        head.store(current, std::memory_order_release);
+    }
+}
+
+std::vector<FileStatus>
+IoUring::statFiles(const std::vector<std::string> &paths) {
+    LOG_INFO << "Retrieving status of " << paths.size() << " files";
+    std::vector<FileStatus> result(paths.size());
+    std::vector<struct statx> buffers(BATCH_SIZE);
+
+    for (std::size_t start = 0; start < paths.size(); start += BATCH_SIZE) {
+        const std::size_t count = std::min(BATCH_SIZE, paths.size() - start);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            io_uring_sqe *sqe = this->queue(i);
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = toAddress(paths[start + i].c_str());
+            sqe->len = STATX_TYPE | STATX_SIZE;
+            sqe->off = toAddress(&buffers[i]);
+        }
+
+        this->submitAndWait([&](std::uint64_t index, int res) {
+            // Any error is treated as if the file doesn't exist
+            if (res < 0) {
+                return;
+            }
+
+            FileStatus &status = result[start + index];
+            status.exists = true;
+            status.isRegularFile = S_ISREG(buffers[index].stx_mode);
+            status.isDirectory = S_ISDIR(buffers[index].stx_mode);
+            status.size = buffers[index].stx_size;
+        });
+    }
+
+    return result;
+}
+
+std::vector<int> IoUring::openFiles(const std::vector<const char *> &paths,
+                                    int flags) {
+    std::vector<int> result(paths.size(), -1);
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        io_uring_sqe *sqe = this->queue(i);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = toAddress(paths[i]);
+        sqe->len = OUTPUT_MODE;
+        sqe->open_flags = static_cast<std::uint32_t>(flags | O_CLOEXEC);
+    }
+
+    this->submitAndWait([&](std::uint64_t index, int res) {
+        result[index] = res;
+    });
+
+    return result;
+}
+
+std::vector<std::optional<InputFile>>
+IoUring::readFiles(const std::vector<std::string> &paths) {
+    LOG_INFO << "Reading " << paths.size() << " files";
+    std::vector<std::optional<InputFile>> result(paths.size());
+    const std::vector<FileStatus> statuses = this->statFiles(paths);
+
+    for (std::size_t start = 0; start < paths.size(); start += BATCH_SIZE) {
+        const std::size_t count = std::min(BATCH_SIZE, paths.size() - start);
+        // Large files are mapped by InputFile instead
+        std::vector<std::size_t> indices;
+        std::vector<const char *> names;
+
+        for (std::size_t i = start; i < start + count; ++i) {
+            if (statuses[i].isRegularFile &&
+                    statuses[i].size < InputFile::MMAP_THRESHOLD) {
+                indices.push_back(i);
+                names.push_back(paths[i].c_str());
+            }
+        }
+
+        const std::vector<int> fds = this->openFiles(names, O_RDONLY);
+        std::vector<std::optional<InputFile>> buffers(indices.size());
+
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            if (fds[i] < 0) {
+                continue;
+            }
+
+            const auto size = static_cast<std::size_t>(statuses[indices[i]].size);
+            buffers[i].emplace(InputFile::allocate(size));
+            io_uring_sqe *readSqe = this->queue(2 * i);
+            readSqe->opcode = IORING_OP_READ;
+            readSqe->fd = fds[i];
+            readSqe->addr = toAddress(buffers[i]->writableData());
+            readSqe->len = static_cast<std::uint32_t>(size);
+            // The close has to happen, even if the read fails
+            readSqe->flags = IOSQE_IO_HARDLINK;
+            io_uring_sqe *closeSqe = this->queue(2 * i + 1);
+            closeSqe->opcode = IORING_OP_CLOSE;
+            closeSqe->fd = fds[i];
+        }
+
+        this->submitAndWait([&](std::uint64_t userData, int res) {
+            const std::size_t i = userData / 2;
+
+            // Only the result of the read is relevant
+            if (userData % 2 != 0) {
+                return;
+            }
+
+            // A short read means the file changed, so it's read again later
+            if (res >= 0 &&
+                    static_cast<std::uint64_t>(res) == statuses[indices[i]].size) {
+                result[indices[i]] = std::move(buffers[i]);
+            }
+        });
+    }
+
+    return result;
+}
+
+std::vector<bool> IoUring::writeFiles(const std::vector<OutputFile> &files) {
+    LOG_INFO << "Writing " << files.size() << " files";
+    std::vector<bool> result(files.size(), false);
+
+    for (std::size_t start = 0; start < files.size(); start += BATCH_SIZE) {
+        const std::size_t count = std::min(BATCH_SIZE, files.size() - start);
+        std::vector<const char *> names;
+
+        for (std::size_t i = start; i < start + count; ++i) {
+            names.push_back(files[i].fileName.c_str());
+        }
+
+        const std::vector<int> fds =
+            this->openFiles(names, O_WRONLY | O_CREAT | O_TRUNC);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (fds[i] < 0) {
+                continue;
+            }
+
+            const std::string_view content = files[start + i].content;
+            io_uring_sqe *writeSqe = this->queue(2 * i);
+            writeSqe->opcode = IORING_OP_WRITE;
+            writeSqe->fd = fds[i];
+            writeSqe->addr = toAddress(content.data());
+            writeSqe->len = static_cast<std::uint32_t>(content.size());
+            writeSqe->flags = IOSQE_IO_HARDLINK;
+            io_uring_sqe *closeSqe = this->queue(2 * i + 1);
+            closeSqe->opcode = IORING_OP_CLOSE;
+            closeSqe->fd = fds[i];
+        }
+
+        this->submitAndWait([&](std::uint64_t userData, int res) {
+            const std::size_t i = start + userData / 2;
+
+            if (userData % 2 == 0) {
+                result[i] = res >= 0 &&
+                            static_cast<std::size_t>(res) == files[i].content.size();
+            }
+        });
+    }
+
+    return result;
+}
+} // namespace utilities
+
+#else // HAS_IO_URING
+
+namespace utilities {
+bool IoUring::isAvailable() {
+    return false;
+}
+
+IoUring::IoUring() {
+    throw std::runtime_error("Built without io_uring support");
+}
+
+IoUring::~IoUring() = default;
+
+void IoUring::teardown() {}
+
+std::vector<FileStatus>
+IoUring::statFiles(const std::vector<std::string> &paths) {
+    return std::vector<FileStatus>(paths.size());
+}
+
+std::vector<std::optional<InputFile>>
+IoUring::readFiles(const std::vector<std::string> &paths) {
+    return std::vector<std::optional<InputFile>>(paths.size());
+}
+
+std::vector<bool> IoUring::writeFiles(const std::vector<OutputFile> &files) {
+    return std::vector<bool>(files.size(), false);
+}
+} // namespace utilities
+
+#endif // HAS_IO_URING
@@ -11,43 +11,68 @@
  */
 
 #include "JsonHandler.hpp"
+#include "BaseCache.hpp"
 #include "Exceptions.hpp"
 #include "FileData.hpp"
+#include "InputFile.hpp"
 #include "KeyValidator.hpp"
 #include "LoggingWrapper.hpp"
+#include "ParallelChunks.hpp"
+#include "PoolAllocator.hpp"
+#include "TemplateExpander.hpp"
 #include "Utils.hpp"
 
 #include <algorithm>
+#include <string>
+#include <string_view>
 
 namespace parsing {
-JsonHandler::JsonHandler(const std::string &filename) {
+// Can open files anywhere with relative/absolute path
+// - {ReqFunc5}
+JsonHandler::JsonHandler(const std::string &filename)
+    : JsonHandler(filename, utilities::InputFile(filename)) {}
+
+JsonHandler::JsonHandler(const std::string &filename,
+                         const utilities::InputFile &input,
+                         std::pmr::memory_resource *resource)
+    : JsonHandler(filename, input.view(), resource) {}
+
+JsonHandler::JsonHandler(const std::string &filename,
+                         std::string_view content,
+                         std::pmr::memory_resource *resource)
+    : filename(filename), resource(resource) {
     LOG_INFO << "Initializing JSONHandler with filename: " << filename << "\n";
-    this->root = parseFile(filename);
+    this->root = parseFile(filename, content);
 }
 
-std::shared_ptr<Json::Value> JsonHandler::parseFile(const std::string &filename)
-
-{
+std::shared_ptr<Json::Value>
+JsonHandler::parseFile(const std::string &filename, std::string_view content) {
     LOG_INFO << "Parsing file: " << filename << "\n";
-    // Can open files anywhere with relative/absolute path
-    // - {ReqFunc5}
-    std::ifstream file(filename);
+    // The file is read once, the parser and validator work on the same range
     Json::Value newRoot;
 
-    // Json::Reader.parse() returns false if parsing fails
-    if (Json::Reader reader; !reader.parse(file, newRoot)) {
-        throw exceptions::ParsingException(filename);
+    // The nodes of the tree are taken from the pool, if it's enabled
+    {
+        const utilities::PoolAllocator::Scope poolScope;
+
+        // Json::Reader.parse() returns false if parsing fails
+        if (Json::Reader reader;
+                !reader.parse(content.data(), content.data() + content.size(), newRoot,
+                              false)) {
+            throw exceptions::ParsingException(filename);
+        }
     }
 
     // Validate keys
     // Check for errors
-    if (auto errors = KeyValidator::getInstance().validateKeys(newRoot, filename);
+    if (auto errors = KeyValidator::getInstance().validateKeys(newRoot, filename,
+                      content);
             !errors.empty()) {
         throw exceptions::InvalidKeyException(errors);
     }
 
     LOG_INFO << "File \"" << filename << "\" has been parsed\n";
-    return std::make_shared<Json::Value>(newRoot);
+    return std::make_shared<Json::Value>(std::move(newRoot));
 }
 
 std::shared_ptr<FileData> JsonHandler::getFileData() {
@@ -55,100 +80,260 @@ std::shared_ptr<FileData> JsonHandler::getFileData() {
     return this->createFileData();
 }
 
-std::shared_ptr<FileData> JsonHandler::createFileData() {
+std::shared_ptr<const FileData> JsonHandler::getBaseFileData() {
+    LOG_INFO << "Creating FileData object of a base...\n";
+    return this->createFileData(true);
+}
+
+std::vector<std::string> JsonHandler::getProfiles() const {
+    const std::string_view profilesKey = "profiles";
+    const Json::Value *profiles = this->root->find(
+                                      profilesKey.data(), profilesKey.data() + profilesKey.size());
+
+    if (profiles == nullptr) {
+        return {};
+    }
+
+    // Validated by KeyValidator to be an object
+    return profiles->getMemberNames();
+}
+
+bool JsonHandler::hasBases() const {
+    return this->root->isMember("extends");
+}
+
+std::shared_ptr<FileData> JsonHandler::getProfileFileData(
+    const std::string &profile, const FileData &shared,
+    std::pmr::memory_resource *resource) const {
+    LOG_INFO << "Creating FileData object of profile " << profile << "...\n";
+    // Assigns the values of the profile like those of a whole file
+    JsonHandler profileHandler;
+    profileHandler.filename = this->filename;
+    profileHandler.root = std::shared_ptr<const Json::Value>(
+                              this->root, &(*this->root)["profiles"][profile]);
+    profileHandler.resource = resource;
+    profileHandler.data = std::allocate_shared<FileData>(
+                              std::pmr::polymorphic_allocator<FileData>(resource));
+    profileHandler.data->extend(shared);
+
+    // The shared outputfile always ends with ".bat", if it is set
+    std::string defaultOutputFile;
+
+    if (const std::string_view outputFile = shared.getOutputFile();
+            !outputFile.empty()) {
+        defaultOutputFile = outputFile.substr(0,
+                                              outputFile.size() - std::string_view(".bat").size());
+        defaultOutputFile += "-" + profile + ".bat";
+    }
+
+    profileHandler.assignOutputFile(defaultOutputFile);
+    profileHandler.assignHideShell();
+    profileHandler.assignApplication();
+    profileHandler.assignEntries();
+    return profileHandler.data;
+}
+
+std::shared_ptr<FileData> JsonHandler::createFileData(bool isBase) {
     LOG_INFO << "Creating FileData object...\n";
-    this->data = std::make_shared<FileData>();
-    this->assignOutputFile();
+    // The control block and all strings are allocated from the same resource
+    this->data = std::allocate_shared<FileData>(
+                     std::pmr::polymorphic_allocator<FileData>(this->resource));
+    this->assignBases();
+
+    if (!isBase || this->root->isMember("outputfile")) {
+        this->assignOutputFile();
+    }
+
     this->assignHideShell();
     this->assignApplication();
     this->assignEntries();
     return this->data;
 }
 
-void JsonHandler::assignOutputFile() const {
+void JsonHandler::assignBases() const {
+    const std::string_view extendsKey = "extends";
+    const Json::Value *extends = this->root->find(
+                                     extendsKey.data(), extendsKey.data() + extendsKey.size());
+
+    if (extends == nullptr) {
+        return;
+    }
+
+    LOG_INFO << "Assigning bases...\n";
+    // Validated by KeyValidator to be a string or an array of strings
+    const auto assignBase = [this](const Json::Value & base) {
+        this->data->extend(*BaseCache::getInstance().get(
+                               BaseCache::resolve(this->filename, base.asString())));
+    };
+
+    if (extends->isArray()) {
+        for (const auto &base : *extends) {
+            assignBase(base);
+        }
+    } else {
+        assignBase(*extends);
+    }
+}
+
+void JsonHandler::assignOutputFile(std::string_view defaultOutputFile) const {
     LOG_INFO << "Assigning outputfile...\n";
-    std::string outputFile = this->root->get("outputfile", "").asString();
+    std::string converted;
+    std::string_view outputFile =
+        getString(*this->root, "outputfile", converted);
+
+    if (outputFile.empty()) {
+        outputFile = defaultOutputFile;
+    }
+
     if (containsBadCharacter(outputFile)) {
-        outputFile = utilities::Utils::escapeString(outputFile);
-        throw exceptions::ContainsBadCharacterException(outputFile);
+        throw exceptions::ContainsBadCharacterException(
+            utilities::Utils::escapeString(outputFile));
     }
     this->data->setOutputFile(outputFile);
 }
 
 void JsonHandler::assignHideShell() const {
     LOG_INFO << "Assigning hide shell...\n";
-    // If the 'hideshell' key is not given, it defaults to false
-    this->data->setHideShell(this->root->get("hideshell", false).asBool());
+    // If the 'hideshell' key is not given, it defaults to false or the base
+    this->data->setHideShell(this->root->get("hideshell",
+                             this->data->getHideShell()).asBool());
 }
 
 void JsonHandler::assignApplication() const {
     LOG_INFO << "Assigning application...\n";
-    std::string application = this->root->get("application", "").asString();
+    std::string converted;
+    const std::string_view application = TemplateExpander::getInstance().expand(
+            "application", getString(*this->root, "application", converted));
     if (containsBadCharacter(application)) {
-        application = utilities::Utils::escapeString(application);
-        throw exceptions::ContainsBadCharacterException(application);
+        throw exceptions::ContainsBadCharacterException(
+            utilities::Utils::escapeString(application));
     }
     this->data->setApplication(application);
 }
 
 void JsonHandler::assignEntries() const {
     LOG_INFO << "Assigning entries...\n";
+    // Looked up instead of get(), which would copy the whole array
+    const std::string_view entriesKey = "entries";
+    const Json::Value *entries = this->root->find(
+                                     entriesKey.data(), entriesKey.data() + entriesKey.size());
 
-    for (const auto &entry : this->root->get("entries", "")) {
-        std::string entryType = entry.get("type", "").asString();
-
-        if (entryType == "EXE") {
-            LOG_INFO << "Calling function to assign command...\n";
-            this->assignCommand(entry);
-        } else if (entryType == "ENV") {
-            LOG_INFO << "Calling function to assign environment variable...\n";
-            this->assignEnvironmentVariable(entry);
-        } else if (entryType == "PATH") {
-            LOG_INFO << "Calling function to assign path value...\n";
-            this->assignPathValue(entry);
-        } else {
-            // Due to validation beforehand - this should never be reached!
-            throw exceptions::UnreachableCodeException(
-                "Unknown entries should be caught by KeyValidator!\nPlease report "
-                "this bug!");
+    if (entries == nullptr) {
+        return;
+    }
+
+    const std::size_t chunks = utilities::ParallelChunks::count(entries->size());
+
+    if (chunks == 1) {
+        for (const auto &entry : *entries) {
+            assignEntry(entry, *this->data);
         }
+
+        return;
+    }
+
+    // Each chunk is bound into a fragment of its own, which are concatenated
+    // in order, so the entries keep their order
+    std::vector<FileData> fragments(chunks);
+    utilities::ParallelChunks::run(entries->begin(), entries->size(), chunks,
+                                   [&fragments](std::size_t chunk, auto first, auto last) {
+        for (; first != last; ++first) {
+            assignEntry(*first, fragments[chunk]);
+        }
+    });
+
+    for (const auto &fragment : fragments) {
+        this->data->concatenate(fragment);
     }
 }
 
-void JsonHandler::assignCommand(const Json::Value &entry) const {
+void JsonHandler::assignEntry(const Json::Value &entry, FileData &data) {
+    std::string converted;
+    const std::string_view entryType = getString(entry, "type", converted);
+
+    if (entryType == "EXE") {
+        LOG_INFO << "Calling function to assign command...\n";
+        assignCommand(entry, data);
+    } else if (entryType == "ENV") {
+        LOG_INFO << "Calling function to assign environment variable...\n";
+        assignEnvironmentVariable(entry, data);
+    } else if (entryType == "PATH") {
+        LOG_INFO << "Calling function to assign path value...\n";
+        assignPathValue(entry, data);
+    } else {
+        // Due to validation beforehand - this should never be reached!
+        throw exceptions::UnreachableCodeException(
+            "Unknown entries should be caught by KeyValidator!\nPlease report "
+            "this bug!");
+    }
+}
+
+void JsonHandler::assignCommand(const Json::Value &entry, FileData &data) {
     LOG_INFO << "Assigning command...\n";
-    std::string command = entry.get("command", "").asString();
+    std::string converted;
+    const std::string_view command = TemplateExpander::getInstance().expand(
+                                         "command", getString(entry, "command", converted));
     if (containsBadCharacter(command)) {
-        command = utilities::Utils::escapeString(command);
-        throw exceptions::ContainsBadCharacterException(command);
+        throw exceptions::ContainsBadCharacterException(
+            utilities::Utils::escapeString(command));
     }
-    this->data->addCommand(command);
+    data.addCommand(command);
 }
 
-void JsonHandler::assignEnvironmentVariable(const Json::Value &entry) const {
+void JsonHandler::assignEnvironmentVariable(const Json::Value &entry,
+        FileData &data) {
     LOG_INFO << "Assigning environment variable...\n";
-    std::string key = entry.get("key", "").asString();
-    std::string value = entry.get("value", "").asString();
+    std::string convertedKey;
+    std::string convertedValue;
+    const std::string_view key = getString(entry, "key", convertedKey);
+    const std::string_view value = TemplateExpander::getInstance().expand(
+                                       "value", getString(entry, "value", convertedValue));
 
     if (containsBadCharacter(key)) {
-        key = utilities::Utils::escapeString(key);
-        throw exceptions::ContainsBadCharacterException(key);
+        throw exceptions::ContainsBadCharacterException(
+            utilities::Utils::escapeString(key));
     }
     if (containsBadCharacter(value)) {
-        value = utilities::Utils::escapeString(value);
-        throw exceptions::ContainsBadCharacterException(value);
+        throw exceptions::ContainsBadCharacterException(
+            utilities::Utils::escapeString(value));
     }
-    this->data->addEnvironmentVariable(key, value);
+    data.addEnvironmentVariable(key, value);
 }
 
-void JsonHandler::assignPathValue(const Json::Value &entry) const {
+void JsonHandler::assignPathValue(const Json::Value &entry, FileData &data) {
     LOG_INFO << "Assigning path value...\n";
-    std::string path = entry.get("path", "").asString();
+    std::string converted;
+    const std::string_view path = TemplateExpander::getInstance().expand(
+                                      "path", getString(entry, "path", converted));
     if (containsBadCharacter(path)) {
-        path = utilities::Utils::escapeString(path);
-        throw exceptions::ContainsBadCharacterException(path);
+        throw exceptions::ContainsBadCharacterException(
+            utilities::Utils::escapeString(path));
     }
-    this->data->addPathValue(path);
+    data.addPathValue(path);
+}
+
+std::string_view JsonHandler::getString(const Json::Value &object,
+                                        std::string_view key,
+                                        std::string &converted) {
+    const Json::Value *value =
+        object.find(key.data(), key.data() + key.size());
+
+    // Like get() with an empty default value
+    if (value == nullptr) {
+        return {};
+    }
+
+    // Strings are viewed within the Json::Value without copying them
+    const char *begin = nullptr;
+    const char *end = nullptr;
+
+    if (value->getString(&begin, &end)) {
+        return {begin, static_cast<std::size_t>(end - begin)};
+    }
+
+    // Other types are converted like before, which may throw
+    converted = value->asString();
+    return converted;
 }
 
 bool JsonHandler::containsBadCharacter(const std::string_view &str) {
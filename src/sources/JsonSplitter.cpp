@@ -0,0 +1,193 @@
+/**
+ * @file JsonSplitter.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-17
+ * @version 0.3.0
+ * @brief Implementation of the JsonSplitter class.
+ *
+ * @see src/include/JsonSplitter.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "JsonSplitter.hpp"
+#include "Exceptions.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace parsing {
+namespace {
+// Whitespace as defined by the JSON grammar
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+} // namespace
+
+JsonSplitter::JsonSplitter(std::string filename, std::string_view content)
+    : filename(std::move(filename)), content(content) {
+    // A byte order mark is skipped by the parser as well
+    const std::string_view byteOrderMark = "\xEF\xBB\xBF";
+    const std::size_t start = skipWhitespace(
+                                  content.starts_with(byteOrderMark) ? byteOrderMark.size() : 0);
+
+    if (start < content.size() && content[start] == '[') {
+        this->layout = Layout::ARRAY;
+        this->position = start + 1;
+    } else if (const std::size_t end = findEnd(start);
+               end > start && skipWhitespace(end) < content.size()) {
+        // Anything after the first value has to be another configuration
+        this->layout = Layout::LINES;
+        this->position = start;
+    }
+
+    if (this->layout != Layout::SINGLE) {
+        LOG_INFO << "File \"" << this->filename
+                 << "\" contains multiple configurations";
+    }
+}
+
+std::optional<JsonSplitter::Element> JsonSplitter::next() {
+    if (this->done) {
+        return std::nullopt;
+    }
+
+    // The whole content is left to the parser, as before
+    if (this->layout == Layout::SINGLE) {
+        this->done = true;
+        return Element{this->content, 0, 1};
+    }
+
+    this->position = skipWhitespace(this->position);
+    const bool atEnd = this->position >= this->content.size();
+
+    if (this->layout == Layout::LINES && atEnd) {
+        this->done = true;
+        return std::nullopt;
+    }
+
+    if (this->layout == Layout::ARRAY) {
+        if (atEnd) {
+            throw exceptions::ParsingException(this->filename);
+        }
+
+        if (this->content[this->position] == ']') {
+            // Nothing but whitespace may follow the array
+            this->done = true;
+
+            if (skipWhitespace(this->position + 1) < this->content.size()) {
+                throw exceptions::ParsingException(this->filename);
+            }
+
+            return std::nullopt;
+        }
+
+        // Elements after the first one are preceded by a comma
+        if (this->index > 0) {
+            if (this->content[this->position] != ',') {
+                throw exceptions::ParsingException(this->filename);
+            }
+
+            this->position = skipWhitespace(this->position + 1);
+        }
+    }
+
+    const std::size_t begin = this->position;
+    const std::size_t end = findEnd(begin);
+
+    // E.g. a closing bracket without an opening one
+    if (end == begin) {
+        this->done = true;
+        throw exceptions::ParsingException(this->filename);
+    }
+
+    this->position = end;
+    return createElement(begin, end);
+}
+
+std::size_t JsonSplitter::skipWhitespace(std::size_t position) const {
+    while (position < this->content.size() &&
+            isWhitespace(this->content[position])) {
+        ++position;
+    }
+
+    return position;
+}
+
+std::size_t JsonSplitter::findEnd(std::size_t position) const {
+    ScanState state;
+    // Unterminated values are reported by the parser
+    return scan(this->content, position, state).value_or(this->content.size());
+}
+
+std::optional<std::size_t> JsonSplitter::scan(std::string_view content,
+        std::size_t position,
+        ScanState &state) {
+    for (; position < content.size(); ++position) {
+        const char c = content[position];
+
+        if (state.inString) {
+            // The escaped character can't end the string
+            if (state.escaped) {
+                state.escaped = false;
+            } else if (c == '\\') {
+                state.escaped = true;
+            } else if (c == '"') {
+                state.inString = false;
+            }
+
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            state.inString = true;
+            break;
+
+        case '{':
+        case '[':
+            ++state.depth;
+            break;
+
+        case '}':
+        case ']':
+            // Closes the surrounding array
+            if (state.depth == 0) {
+                return position;
+            }
+
+            if (--state.depth == 0) {
+                return position + 1;
+            }
+
+            break;
+
+        case ',':
+            if (state.depth == 0) {
+                return position;
+            }
+
+            break;
+
+        default:
+            if (state.depth == 0 && isWhitespace(c)) {
+                return position;
+            }
+
+            break;
+        }
+    }
+
+    return std::nullopt;
+}
+
+JsonSplitter::Element JsonSplitter::createElement(std::size_t begin,
+        std::size_t end) {
+    this->line += static_cast<std::size_t>(std::count(
+            this->content.begin() + static_cast<std::ptrdiff_t>(this->lineStart),
+            this->content.begin() + static_cast<std::ptrdiff_t>(begin), '\n'));
+    this->lineStart = begin;
+    return {this->content.substr(begin, end - begin), this->index++, this->line};
+}
+} // namespace parsing
@@ -12,8 +12,11 @@
 #include "KeyValidator.hpp"
 #include "Exceptions.hpp"
 #include "LoggingWrapper.hpp"
+#include "ParallelChunks.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
 #include <optional>
-#include <regex>
 #include <vector>
 
 namespace parsing {
@@ -25,42 +28,125 @@ KeyValidator &KeyValidator::getInstance() {
 
 std::vector<std::tuple<int, std::string>>
 KeyValidator::validateKeys(const Json::Value &root,
-                           const std::string &filename) {
+                           const std::string &filename,
+                           std::string_view content) {
     LOG_INFO << "Validating keys for file " << filename;
     std::vector<std::tuple<int, std::string>> wrongKeys =
-        getWrongKeys(root, filename);
+        getWrongKeys(root, filename, content);
 
-    // Inline declaration to prevent leaking in outer scope
-    for (Json::Value entries = root.get("entries", "");
-            const auto &entry : entries) {
-        LOG_INFO << "Validating entry";
-        const auto entryKeys = entry.getMemberNames();
-        // Create a set of the entry keys for faster lookup (O(1) instead of O(n))
-        std::unordered_set<std::string> entryKeysSet(entryKeys.begin(),
-                entryKeys.end());
+    const std::string_view extendsKey = "extends";
 
-        const auto wrongEntries = validateEntries(filename, entryKeysSet);
+    if (const Json::Value *extends =
+                root.find(extendsKey.data(), extendsKey.data() + extendsKey.size())) {
+        validateExtends(*extends);
+    }
 
-        // Combine wrong keys
-        wrongKeys.insert(wrongKeys.end(), wrongEntries.begin(), wrongEntries.end());
+    const std::string_view profilesKey = "profiles";
 
-        LOG_INFO << "Validating types for entry";
-        validateTypes(filename, entry, entryKeysSet);
+    if (const Json::Value *profiles =
+                root.find(profilesKey.data(), profilesKey.data() + profilesKey.size())) {
+        validateProfiles(*profiles, content, wrongKeys);
     }
 
+    validateEntryList(root, content, wrongKeys);
     return wrongKeys;
 }
 
+void KeyValidator::validateEntryList(const Json::Value &object,
+                                     std::string_view content,
+                                     std::vector<std::tuple<int, std::string>> &wrongKeys) {
+    // Looked up instead of get(), which would copy the whole array
+    const std::string_view entriesKey = "entries";
+    const Json::Value *entries =
+        object.find(entriesKey.data(), entriesKey.data() + entriesKey.size());
+
+    if (entries == nullptr) {
+        return;
+    }
+
+    const std::size_t chunks = utilities::ParallelChunks::count(entries->size());
+
+    if (chunks == 1) {
+        for (const auto &entry : *entries) {
+            this->validateEntry(entry, content, wrongKeys);
+        }
+
+        return;
+    }
+
+    // The wrong keys of each chunk are combined in the order of the chunks
+    std::vector<std::vector<std::tuple<int, std::string>>> chunkWrongKeys(chunks);
+    utilities::ParallelChunks::run(entries->begin(), entries->size(), chunks,
+                                   [&](std::size_t chunk, auto first, auto last) {
+        for (; first != last; ++first) {
+            this->validateEntry(*first, content, chunkWrongKeys[chunk]);
+        }
+    });
+
+    for (auto &found : chunkWrongKeys) {
+        std::ranges::move(found, std::back_inserter(wrongKeys));
+    }
+}
+
+void KeyValidator::validateEntry(const Json::Value &entry,
+                                 std::string_view content,
+                                 std::vector<std::tuple<int, std::string>> &wrongKeys) {
+    LOG_INFO << "Validating entry";
+    const auto entryKeys = entry.getMemberNames();
+    // Create a set of the entry keys for faster lookup (O(1) instead of O(n))
+    std::unordered_set<std::string> entryKeysSet(entryKeys.begin(),
+            entryKeys.end());
+
+    const auto wrongEntries = validateEntries(content, entryKeysSet);
+
+    // Combine wrong keys
+    wrongKeys.insert(wrongKeys.end(), wrongEntries.begin(), wrongEntries.end());
+
+    LOG_INFO << "Validating types for entry";
+    validateTypes(content, entry, entryKeysSet);
+}
+
+void KeyValidator::validateProfiles(const Json::Value &profiles,
+                                    std::string_view content,
+                                    std::vector<std::tuple<int, std::string>> &wrongKeys) {
+    if (!profiles.isObject()) {
+        throw exceptions::InvalidValueException(
+            "profiles", "Has to be an object containing the profiles by name!");
+    }
+
+    for (const auto &name : profiles.getMemberNames()) {
+        LOG_INFO << "Validating profile " << name;
+        const Json::Value &profile = profiles[name];
+
+        if (!profile.isObject()) {
+            throw exceptions::InvalidValueException(
+                "profiles", "The profile \"" + name + "\" has to be an object!");
+        }
+
+        for (const auto &key : profile.getMemberNames()) {
+            if (!validProfileKeys.contains(key)) {
+                LOG_WARNING << "Found wrong key " << key << " in profile " << name
+                            << "!";
+                wrongKeys.emplace_back(getUnknownKeyLine(content, key).value_or(-1),
+                                       key);
+            }
+        }
+
+        validateEntryList(profile, content, wrongKeys);
+    }
+}
+
 std::vector<std::tuple<int, std::string>>
 KeyValidator::getWrongKeys(const Json::Value &root,
-                           const std::string &filename) const {
+                           const std::string &filename,
+                           std::string_view content) const {
     std::vector<std::tuple<int, std::string>> wrongKeys = {};
 
     LOG_INFO << "Checcking for wrong keys in file " << filename << "!";
     for (const auto &key : root.getMemberNames()) {
         if (!validKeys.contains(key)) {
             LOG_WARNING << "Found wrong key " << key << "!";
-            const auto error = getUnknownKeyLine(filename, key);
+            const auto error = getUnknownKeyLine(content, key);
 
             if (!error.has_value()) {
                 LOG_ERROR << "Unable to find line of wrong key!";
@@ -76,14 +162,14 @@ KeyValidator::getWrongKeys(const Json::Value &root,
 }
 
 std::vector<std::tuple<int, std::string>> KeyValidator::validateEntries(
-    const std::string &filename,
+    std::string_view content,
     const std::unordered_set<std::string> &entryKeys) const {
     std::vector<std::tuple<int, std::string>> wrongKeys = {};
 
     for (const auto &key : entryKeys) {
         LOG_INFO << "Checking key " << key << "!";
         if (!validEntryKeys.contains(key)) {
-            const auto error = getUnknownKeyLine(filename, key);
+            const auto error = getUnknownKeyLine(content, key);
 
             if (!error.has_value()) {
                 LOG_ERROR << "Unable to find line of wrong key!";
@@ -98,7 +184,7 @@ std::vector<std::tuple<int, std::string>> KeyValidator::validateEntries(
 }
 
 void KeyValidator::validateTypes(
-    const std::string &filename, const Json::Value &entry,
+    std::string_view content, const Json::Value &entry,
     const std::unordered_set<std::string> &entryKeys) {
     // Gett the type of the entry - error if not found
     const std::string type = entry.get("type", "ERROR").asString();
@@ -111,7 +197,7 @@ void KeyValidator::validateTypes(
         // @note This should already have been checked
     } else if (!typeToKeys.contains(type)) {
         const std::optional<int> line =
-            getUnknownKeyLine(filename, std::string(type));
+            getUnknownKeyLine(content, std::string(type));
 
         if (!line.has_value()) {
             LOG_INFO << "Unable to find line of wrong type!";
@@ -120,7 +206,8 @@ void KeyValidator::validateTypes(
         throw exceptions::InvalidTypeException(std::string(type), line.value());
         // If the type is known, check if all necessary keys are present
     } else {
-        for (const auto &key : typeToKeys[type]) {
+        // at() doesn't modify the map, so files can be validated concurrently
+        for (const auto &key : typeToKeys.at(type)) {
             LOG_INFO << "Checking key " << key << " for type " << type;
             if (!entryKeys.contains(key)) {
                 throw exceptions::MissingKeyException(key, type);
@@ -130,29 +217,53 @@ void KeyValidator::validateTypes(
 }
 
 std::optional<int>
-KeyValidator::getUnknownKeyLine(const std::string &filename,
+KeyValidator::getUnknownKeyLine(std::string_view content,
                                 const std::string &wrongKey) {
-    std::ifstream file(filename);
-    LOG_INFO << "Checking for key " << wrongKey << " in file " << filename;
+    LOG_INFO << "Checking for key " << wrongKey;
+
+    // Matches the wrong key as a whole word like the regex \bkey\b, which
+    // isn't used as std::regex isn't safe to construct on several threads
+    const auto isWord = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+    };
+    const auto isBoundary = [&content, &isWord](std::size_t position) {
+        const bool before = position > 0 && isWord(content[position - 1]);
+        const bool after = position < content.size() && isWord(content[position]);
+        return before != after;
+    };
+    std::size_t position = content.find(wrongKey);
+
+    while (position != std::string_view::npos &&
+            !(isBoundary(position) && isBoundary(position + wrongKey.size()))) {
+        position = content.find(wrongKey, position + 1);
+    }
 
-    if (!file.is_open()) {
-        LOG_ERROR << "File not open!";
+    if (position == std::string_view::npos) {
         return std::nullopt;
     }
 
-    std::string line;
-    // Create a regex pattern that matches the wrong key whole word
-    const std::regex wrongKeyPattern("\\b" + wrongKey + "\\b");
+    // The line is the number of line breaks before the match plus one
+    const auto lineNumber = static_cast<int>(std::count(content.begin(),
+                            content.begin() + static_cast<std::ptrdiff_t>(position), '\n')) + 1;
+    LOG_INFO << "Found key " << wrongKey << " in line " << lineNumber;
 
-    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
-        if (std::regex_search(line, wrongKeyPattern)) {
-            LOG_INFO << "Found key " << wrongKey << " in line " << lineNumber;
+    return lineNumber;
+}
 
-            return lineNumber;
-        }
+void KeyValidator::validateExtends(const Json::Value &extends) {
+    LOG_INFO << "Validating extends";
+    const auto isPath = [](const Json::Value & value) {
+        return value.isString() && !value.asString().empty();
+    };
+
+    if (isPath(extends)) {
+        return;
     }
 
-    return std::nullopt;
+    if (!extends.isArray() || !std::all_of(extends.begin(), extends.end(), isPath)) {
+        throw exceptions::InvalidValueException(
+            "extends", "Has to be the path of a file or a list of paths!");
+    }
 }
 
 } // namespace parsing
@@ -0,0 +1,146 @@
+/**
+ * @file Optimizer.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-22
+ * @version 0.3.0
+ * @brief Implementation of the Optimizer class.
+ *
+ * @see src/include/Optimizer.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "Optimizer.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_set>
+
+namespace parsing {
+namespace {
+// Summed up statistics of all files
+std::mutex statisticsMutex;
+Optimizer::Statistics statistics;
+
+/**
+ * @brief Text around a PATH entry within the single line layout (";")
+ */
+constexpr std::size_t PATH_SEPARATOR_SIZE = 1;
+
+/**
+ * @brief Text around a variable within the single line layout
+ */
+constexpr std::size_t VARIABLE_SEPARATOR_SIZE = std::string_view(
+            "set = && ").size();
+
+char toLower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+} // namespace
+
+Optimizer::Statistics Optimizer::optimize(FileData &data) {
+    LOG_INFO << "Optimizing the entries...";
+    const Statistics paths = removeDuplicatePaths(data);
+    const Statistics variables = removeOverriddenVariables(data);
+    const Statistics result{1, paths.paths, variables.variables,
+                            paths.bytes + variables.bytes};
+    OUTPUT << "Removed " << result.paths << " duplicate PATH entries and "
+           << result.variables << " overridden variables, saving "
+           << result.bytes << " bytes\n";
+
+    std::scoped_lock lock(statisticsMutex);
+    statistics.files += result.files;
+    statistics.paths += result.paths;
+    statistics.variables += result.variables;
+    statistics.bytes += result.bytes;
+    return result;
+}
+
+Optimizer::Statistics Optimizer::getStatistics() {
+    std::scoped_lock lock(statisticsMutex);
+    return statistics;
+}
+
+std::size_t Optimizer::CaseInsensitiveHash::operator()(
+    std::string_view value) const {
+    // FNV-1a of the lower case characters
+    std::size_t hash = 14695981039346656037ULL;
+
+    for (const char c : value) {
+        hash = (hash ^ static_cast<unsigned char>(toLower(c))) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+bool Optimizer::CaseInsensitiveEqual::operator()(std::string_view left,
+        std::string_view right) const {
+    return std::ranges::equal(left, right, {}, toLower, toLower);
+}
+
+std::string_view Optimizer::normalizePath(std::string_view path) {
+    while (path.size() > 1 && path.ends_with('\\') &&
+            path[path.size() - 2] != ':') {
+        path.remove_suffix(1);
+    }
+
+    return path;
+}
+
+Optimizer::Statistics Optimizer::removeDuplicatePaths(FileData &data) {
+    Statistics result;
+    std::pmr::unordered_set<std::string_view, CaseInsensitiveHash,
+        CaseInsensitiveEqual> seen(data.get_allocator());
+    seen.reserve(data.pathValues.size());
+    std::size_t kept = 0;
+
+    // The first occurrence is kept, to keep the order of the search path
+    for (const Span path : data.pathValues) {
+        if (seen.insert(normalizePath(data.view(path))).second) {
+            data.pathValues[kept++] = path;
+        } else {
+            ++result.paths;
+            result.bytes += path.length + PATH_SEPARATOR_SIZE;
+        }
+    }
+
+    data.pathValues.resize(kept);
+    return result;
+}
+
+Optimizer::Statistics Optimizer::removeOverriddenVariables(FileData &data) {
+    Statistics result;
+    const std::size_t count = data.environmentKeys.size();
+    std::pmr::unordered_set<std::string_view, CaseInsensitiveHash,
+        CaseInsensitiveEqual> seen(data.get_allocator());
+    seen.reserve(count);
+    std::pmr::vector<bool> keep(count, false, data.get_allocator());
+
+    // The last assignment is the one that counts
+    for (std::size_t i = count; i-- > 0;) {
+        keep[i] = seen.insert(data.view(data.environmentKeys[i])).second;
+    }
+
+    std::size_t kept = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (keep[i]) {
+            data.environmentKeys[kept] = data.environmentKeys[i];
+            data.environmentValues[kept] = data.environmentValues[i];
+            ++kept;
+        } else {
+            ++result.variables;
+            result.bytes += data.environmentKeys[i].length +
+                            data.environmentValues[i].length +
+                            VARIABLE_SEPARATOR_SIZE;
+        }
+    }
+
+    data.environmentKeys.resize(kept);
+    data.environmentValues.resize(kept);
+    return result;
+}
+} // namespace parsing
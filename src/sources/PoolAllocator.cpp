@@ -0,0 +1,477 @@
+/**
+ * @file PoolAllocator.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-14
+ * @version 0.3.0
+ * @brief Implementation of the PoolAllocator class.
+ * @details
+ * If built with JSON2BATCH_POOL_ALLOCATOR, this file also replaces the
+ * global operator new and delete, which only use the pool within a
+ * PoolAllocator::Scope.
+ *
+ * @see src/include/PoolAllocator.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "PoolAllocator.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#ifdef IS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace utilities {
+namespace {
+constexpr std::size_t CLASS_COUNT =
+    PoolAllocator::MAX_SIZE / PoolAllocator::GRANULARITY;
+// Addresses reserved for the slabs, only the slabs in use take memory. Too
+// large for 32 bit systems, where the pool isn't used.
+constexpr std::size_t REGION_SIZE = sizeof(void *) >= 8 ?
+                                    static_cast<std::size_t>(std::uint64_t{16} << 30) : 0;
+// The blocks of a slab start after its header and keep the alignment of
+// malloc()
+constexpr std::size_t HEADER_SIZE = 64;
+
+struct Cache;
+
+// A free block, the pointer is stored within the payload
+struct Block {
+    Block *next;
+};
+
+// The header of a slab, only the owner uses the fields which aren't atomic
+struct Slab {
+    std::atomic<Block *> remote; // Freed by other threads
+    std::atomic<Cache *> owner; // nullptr if the thread has ended
+    Block *free; // Freed by the owner
+    std::byte *unused; // The blocks from here on haven't been used yet
+    Slab *previous; // Within the list of the owner
+    Slab *next; // Within the list of the owner or a global list
+    std::uint32_t live; // Blocks in use, including those in remote
+    std::uint32_t sizeClass;
+};
+
+static_assert(sizeof(Slab) <= HEADER_SIZE);
+
+// Everything is trivially destructible, so that it can still be used while
+// the other thread local objects are destroyed
+struct Cache {
+    Slab *slabs[CLASS_COUNT]; // Per size class, allocating from the first
+    unsigned scopes;
+    std::uint64_t allocations;
+    std::uint64_t pooled;
+    bool registered;
+    bool ended;
+};
+
+// Hands the slabs over to the other threads, once a thread ends
+struct CacheFlusher {
+    ~CacheFlusher();
+};
+
+thread_local Cache cache{};
+thread_local CacheFlusher flusher;
+
+// Set once the addresses are reserved
+std::atomic<std::uintptr_t> regionBegin{0};
+std::atomic<std::uintptr_t> regionEnd{0};
+
+// Guards the slabs, which don't belong to a thread
+std::mutex slabMutex;
+std::byte *regionNext = nullptr; // The first slab never used
+Slab *emptySlabs = nullptr; // Given back to the system, may be reused
+Slab *abandoned[CLASS_COUNT] = {}; // Slabs in use of ended threads
+
+// Counts of ended threads
+std::atomic<std::uint64_t> endedAllocations{0};
+std::atomic<std::uint64_t> endedPooled{0};
+std::atomic<std::uint64_t> slabCount{0};
+std::atomic<std::uint64_t> releasedCount{0};
+
+bool reserveRegion() {
+    static const bool reserved = [] {
+#ifdef IS_UNIX
+#ifdef MAP_NORESERVE
+        constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#else
+        constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+
+        if (REGION_SIZE == 0) {
+            return false;
+        }
+
+        // Reserved without access, each slab is made accessible once used
+        void *memory = mmap(nullptr, REGION_SIZE + PoolAllocator::SLAB_SIZE,
+                            PROT_NONE, flags, -1, 0);
+
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+
+        // Aligned, so the slab of a block is found by its address
+        const std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(memory) +
+                                      PoolAllocator::SLAB_SIZE - 1) & ~(PoolAllocator::SLAB_SIZE - 1);
+        regionNext = reinterpret_cast<std::byte *>(begin);
+        regionEnd.store(begin + REGION_SIZE, std::memory_order_relaxed);
+        regionBegin.store(begin, std::memory_order_release);
+        return true;
+#else
+        return false;
+#endif
+    }();
+    return reserved;
+}
+
+bool isPooled(const void *pointer) {
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+    const std::uintptr_t begin = regionBegin.load(std::memory_order_acquire);
+    return begin != 0 && address >= begin &&
+           address < regionEnd.load(std::memory_order_relaxed);
+}
+
+Slab *slabOf(void *pointer) {
+    return reinterpret_cast<Slab *>(reinterpret_cast<std::uintptr_t>(pointer) &
+                                    ~(PoolAllocator::SLAB_SIZE - 1));
+}
+
+// Takes over the blocks freed by other threads
+void drain(Slab &slab) {
+    Block *list = slab.remote.exchange(nullptr, std::memory_order_acquire);
+
+    while (list != nullptr) {
+        Block *next = list->next;
+        list->next = slab.free;
+        slab.free = list;
+        --slab.live;
+        list = next;
+    }
+}
+
+void *takeBlock(Slab &slab) {
+    if (slab.free == nullptr) {
+        drain(slab);
+    }
+
+    void *block = slab.free;
+
+    if (block != nullptr) {
+        slab.free = slab.free->next;
+    } else if (const std::size_t size = (slab.sizeClass + 1) *
+                                        PoolAllocator::GRANULARITY;
+               slab.unused + size <= reinterpret_cast<std::byte *>(&slab) +
+               PoolAllocator::SLAB_SIZE) {
+        block = slab.unused;
+        slab.unused += size;
+    } else {
+        return nullptr;
+    }
+
+    ++slab.live;
+    return block;
+}
+
+void link(Cache &local, Slab *slab) {
+    Slab *&first = local.slabs[slab->sizeClass];
+    slab->previous = nullptr;
+    slab->next = first;
+
+    if (first != nullptr) {
+        first->previous = slab;
+    }
+
+    first = slab;
+}
+
+void unlink(Cache &local, Slab *slab) {
+    if (slab->previous != nullptr) {
+        slab->previous->next = slab->next;
+    } else {
+        local.slabs[slab->sizeClass] = slab->next;
+    }
+
+    if (slab->next != nullptr) {
+        slab->next->previous = slab->previous;
+    }
+}
+
+// The mutex has to be locked
+void releaseLocked(Slab *slab) {
+    slab->owner.store(nullptr, std::memory_order_relaxed);
+#ifdef IS_UNIX
+    // The header is kept, as it links the empty slabs
+    static const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    if (pageSize < PoolAllocator::SLAB_SIZE) {
+        madvise(reinterpret_cast<std::byte *>(slab) + pageSize,
+                PoolAllocator::SLAB_SIZE - pageSize, MADV_DONTNEED);
+    }
+
+#endif
+    slab->next = emptySlabs;
+    emptySlabs = slab;
+    ++releasedCount;
+}
+
+void release(Slab *slab) {
+    std::scoped_lock lock(slabMutex);
+    releaseLocked(slab);
+}
+
+// Called if the first slab of the size class has no block left
+Slab *refill(Cache &local, std::size_t sizeClass) {
+    Slab *first = local.slabs[sizeClass];
+
+    // The other slabs may have got blocks back from other threads
+    for (Slab *slab = first != nullptr ? first->next : nullptr; slab != nullptr;) {
+        Slab *next = slab->next;
+        drain(*slab);
+
+        if (slab->free != nullptr) {
+            unlink(local, slab);
+            link(local, slab);
+            return slab;
+        }
+
+        slab = next;
+    }
+
+    std::scoped_lock lock(slabMutex);
+
+    // Slabs of ended threads are taken over, once blocks have been freed
+    for (Slab **slab = &abandoned[sizeClass]; *slab != nullptr;) {
+        Slab *candidate = *slab;
+        drain(*candidate);
+
+        if (candidate->live == 0) {
+            *slab = candidate->next;
+            releaseLocked(candidate);
+        } else if (candidate->free != nullptr) {
+            *slab = candidate->next;
+            candidate->owner.store(&local, std::memory_order_relaxed);
+            link(local, candidate);
+            return candidate;
+        } else {
+            slab = &candidate->next;
+        }
+    }
+
+    std::byte *memory = nullptr;
+
+    if (emptySlabs != nullptr) {
+        memory = reinterpret_cast<std::byte *>(emptySlabs);
+        emptySlabs = emptySlabs->next;
+    } else {
+        if (regionNext == reinterpret_cast<std::byte *>(regionEnd.load(
+                    std::memory_order_relaxed))) {
+            return nullptr;
+        }
+
+#ifdef IS_UNIX
+
+        if (mprotect(regionNext, PoolAllocator::SLAB_SIZE,
+                     PROT_READ | PROT_WRITE) != 0) {
+            return nullptr;
+        }
+
+#endif
+        memory = regionNext;
+        regionNext += PoolAllocator::SLAB_SIZE;
+        ++slabCount;
+    }
+
+    auto *slab = new (memory) Slab{};
+    slab->owner.store(&local, std::memory_order_relaxed);
+    slab->unused = memory + HEADER_SIZE;
+    slab->sizeClass = static_cast<std::uint32_t>(sizeClass);
+    link(local, slab);
+    return slab;
+}
+
+CacheFlusher::~CacheFlusher() {
+    for (std::size_t sizeClass = 0; sizeClass < CLASS_COUNT; ++sizeClass) {
+        while (Slab *slab = cache.slabs[sizeClass]) {
+            unlink(cache, slab);
+            drain(*slab);
+            std::scoped_lock lock(slabMutex);
+
+            if (slab->live == 0) {
+                releaseLocked(slab);
+                continue;
+            }
+
+            // Blocks freed from now on are pushed onto the remote list
+            slab->owner.store(nullptr, std::memory_order_relaxed);
+            slab->next = abandoned[sizeClass];
+            abandoned[sizeClass] = slab;
+        }
+    }
+
+    endedAllocations += cache.allocations;
+    endedPooled += cache.pooled;
+    cache.allocations = 0;
+    cache.pooled = 0;
+    // Memory allocated from now on is taken from malloc()
+    cache.ended = true;
+}
+} // namespace
+
+PoolAllocator::Scope::Scope() noexcept {
+    ++cache.scopes;
+}
+
+PoolAllocator::Scope::~Scope() {
+    --cache.scopes;
+}
+
+void *PoolAllocator::allocate(std::size_t size) noexcept {
+    Cache &local = cache;
+
+    // malloc() may return nullptr for 0 bytes, which would be taken as failure
+    if (local.scopes == 0 || local.ended) {
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    ++local.allocations;
+
+    if (size > MAX_SIZE || !reserveRegion()) {
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    if (!local.registered) {
+        local.registered = true;
+        // Using the flusher makes sure it's destroyed when the thread ends
+        static_cast<void>(&flusher);
+    }
+
+    const std::size_t sizeClass = size == 0 ? 0 : (size - 1) / GRANULARITY;
+    Slab *slab = local.slabs[sizeClass];
+    void *pointer = slab != nullptr ? takeBlock(*slab) : nullptr;
+
+    if (pointer == nullptr) {
+        // Without any address left, the request is passed on
+        if (slab = refill(local, sizeClass); slab == nullptr) {
+            return std::malloc(size == 0 ? 1 : size);
+        }
+
+        pointer = takeBlock(*slab);
+    }
+
+    ++local.pooled;
+    return pointer;
+}
+
+void PoolAllocator::deallocate(void *pointer) noexcept {
+    if (!isPooled(pointer)) {
+        std::free(pointer);
+        return;
+    }
+
+    Slab *slab = slabOf(pointer);
+    auto *block = static_cast<Block *>(pointer);
+    Cache &local = cache;
+
+    if (!local.ended &&
+            slab->owner.load(std::memory_order_relaxed) == &local) {
+        block->next = slab->free;
+        slab->free = block;
+
+        // The slab allocated from is kept, even if it's empty
+        if (--slab->live == 0 && slab != local.slabs[slab->sizeClass]) {
+            unlink(local, slab);
+            release(slab);
+        }
+
+        return;
+    }
+
+    // Taken over by the owner, once it runs out of blocks
+    Block *head = slab->remote.load(std::memory_order_relaxed);
+
+    do {
+        block->next = head;
+    } while (!slab->remote.compare_exchange_weak(head, block,
+             std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool PoolAllocator::isEnabled() {
+#ifdef USE_POOL_ALLOCATOR
+    return true;
+#else
+    return false;
+#endif
+}
+
+PoolAllocator::Statistics PoolAllocator::getStatistics() {
+    return {endedAllocations + cache.allocations, endedPooled + cache.pooled,
+            slabCount, releasedCount};
+}
+} // namespace utilities
+
+#ifdef USE_POOL_ALLOCATOR
+// Replacements of the global operator new and delete
+// The aligned variants are kept, as they use their own operator delete
+
+void *operator new(std::size_t size) {
+    void *pointer = nullptr;
+
+    // Behaves like the default implementation, if no memory is left
+    while ((pointer = utilities::PoolAllocator::allocate(size)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        handler();
+    }
+
+    return pointer;
+}
+
+void *operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return ::operator new(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void *pointer) noexcept {
+    utilities::PoolAllocator::deallocate(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    utilities::PoolAllocator::deallocate(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    utilities::PoolAllocator::deallocate(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    utilities::PoolAllocator::deallocate(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    utilities::PoolAllocator::deallocate(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+    utilities::PoolAllocator::deallocate(pointer);
+}
+#endif // USE_POOL_ALLOCATOR
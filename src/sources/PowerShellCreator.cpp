@@ -0,0 +1,85 @@
+/**
+ * @file PowerShellCreator.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-24
+ * @version 0.3.0
+ * @brief Implementation of the PowerShellCreator class.
+ *
+ * @see src/include/PowerShellCreator.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "PowerShellCreator.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <utility>
+
+PowerShellCreator::PowerShellCreator(
+    std::shared_ptr<parsing::FileData> fileData)
+    : ScriptCreator(std::move(fileData)) {
+    LOG_INFO << "Creating PowerShell script";
+    this->createScript(ENTRY_SIZE);
+}
+
+void PowerShellCreator::writeStart() {
+    this->content.append("$ErrorActionPreference = 'Stop'\r\n");
+}
+
+void PowerShellCreator::writeCommands() {
+    for (const auto &command : this->fileData->getCommands()) {
+        this->content.append("cmd.exe /c '").append(command).append(
+            "'\r\nif ($LASTEXITCODE -ne 0) { exit $LASTEXITCODE }\r\n");
+    }
+}
+
+void PowerShellCreator::writeEnvVariables() {
+    for (const auto &[key, value] : this->fileData->getEnvironmentVariables()) {
+        // Braced, as names like ProgramFiles(x86) end a plain $env:name
+        this->content.append("${env:");
+
+        for (const char c : key) {
+            // Escaped by a backtick within the braces
+            if (c == '}' || c == '`') {
+                this->content.push_back('`');
+            }
+
+            this->content.push_back(c);
+        }
+
+        this->content.append("} = '").append(value).append("'\r\n");
+    }
+}
+
+void PowerShellCreator::writePathVariables() {
+    const auto paths = this->fileData->getPathValues();
+
+    if (paths.empty()) {
+        return;
+    }
+
+    this->content.append("$env:Path = '");
+
+    for (const auto &path : paths) {
+        this->content.append(path).append(";");
+    }
+
+    this->content.append("' + $env:Path\r\n");
+}
+
+void PowerShellCreator::writeApplication() {
+    if (const auto application = this->fileData->getApplication()) {
+        // The whole argument list is passed on as it is
+        this->content.append("Start-Process cmd.exe -ArgumentList '/c start \"")
+        .append(this->getName())
+        .append("\" ")
+        .append(*application)
+        .append("'\r\n");
+    }
+}
+
+void PowerShellCreator::writeEnd() {
+    if (!this->fileData->getHideShell()) {
+        this->content.append("powershell.exe -NoLogo -NoExit\r\n");
+    }
+}
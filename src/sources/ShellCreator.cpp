@@ -0,0 +1,97 @@
+/**
+ * @file ShellCreator.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-24
+ * @version 0.3.0
+ * @brief Implementation of the ShellCreator class.
+ *
+ * @see src/include/ShellCreator.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "ShellCreator.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+namespace {
+/**
+ * @brief Checks whether a key can be exported by a POSIX shell
+ *
+ * @param key The key of an environment variable
+ *
+ * @return True if the key matches [A-Za-z_][A-Za-z0-9_]*
+ */
+bool isShellName(std::string_view key) {
+    const auto isAlpha = [](char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+    };
+
+    return !key.empty() && isAlpha(key.front()) &&
+           std::ranges::all_of(key.substr(1), [&isAlpha](char c) {
+        return isAlpha(c) || (c >= '0' && c <= '9');
+    });
+}
+} // namespace
+
+ShellCreator::ShellCreator(std::shared_ptr<parsing::FileData> fileData)
+    : ScriptCreator(std::move(fileData)) {
+    LOG_INFO << "Creating shell script";
+    this->createScript(ENTRY_SIZE);
+}
+
+void ShellCreator::writeStart() {
+    this->content.append("#!/bin/sh\n");
+}
+
+void ShellCreator::writeCommands() {
+    for (const auto &command : this->fileData->getCommands()) {
+        this->content.append(command).append(" || exit $?\n");
+    }
+}
+
+void ShellCreator::writeEnvVariables() {
+    for (const auto &[key, value] : this->fileData->getEnvironmentVariables()) {
+        // Names like ProgramFiles(x86) would break the whole script
+        if (!isShellName(key)) {
+            LOG_WARNING << "Skipping variable \"" << key << "\" in "
+                        << this->fileData->getOutputFile()
+                        << ", it is not a valid shell variable name";
+            continue;
+        }
+
+        this->content.append("export ").append(key).append("='").append(
+            value).append("'\n");
+    }
+}
+
+void ShellCreator::writePathVariables() {
+    const auto paths = this->fileData->getPathValues();
+
+    if (paths.empty()) {
+        return;
+    }
+
+    this->content.append("PATH='");
+
+    for (const auto &path : paths) {
+        this->content.append(path).append(":");
+    }
+
+    this->content.append("'\"$PATH\"\nexport PATH\n");
+}
+
+void ShellCreator::writeApplication() {
+    if (const auto application = this->fileData->getApplication()) {
+        this->content.append(*application).append(" &\n");
+    }
+}
+
+void ShellCreator::writeEnd() {
+    if (!this->fileData->getHideShell()) {
+        this->content.append("exec \"${SHELL:-/bin/sh}\"\n");
+    }
+}
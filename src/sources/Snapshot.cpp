@@ -0,0 +1,190 @@
+/**
+ * @file Snapshot.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-16
+ * @version 0.3.0
+ * @brief Implementation of the Snapshot class.
+ *
+ * @see src/include/Snapshot.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "Snapshot.hpp"
+#include "Exceptions.hpp"
+#include "JsonHandler.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace parsing {
+// The header and the spans are written as is
+static_assert(std::is_trivially_copyable_v<Span> && sizeof(Span) == 8);
+
+namespace {
+/**
+ * @brief Reverses the bytes of a value, like std::byteswap() of C++23
+ */
+constexpr std::uint32_t swapBytes(std::uint32_t value) {
+    return (value >> 24) | ((value >> 8) & 0xFF00U) |
+           ((value << 8) & 0xFF0000U) | (value << 24);
+}
+} // namespace
+
+bool Snapshot::isSnapshot(std::string_view content) {
+    return content.size() >= sizeof(MAGIC) &&
+           std::memcmp(content.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::pmr::string Snapshot::serialize(const FileData &data,
+                                     const FileData::allocator_type &allocator) {
+    LOG_INFO << "Serializing snapshot of " << data.getOutputFile();
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.flags = (data.hideShell ? HIDE_SHELL : 0) |
+                   (data.application.has_value() ? HAS_APPLICATION : 0);
+    header.commandCount = static_cast<std::uint32_t>(data.commands.size());
+    header.environmentCount =
+        static_cast<std::uint32_t>(data.environmentKeys.size());
+    header.pathCount = static_cast<std::uint32_t>(data.pathValues.size());
+
+    // Interned values are stored within the snapshot like all others, so it
+    // doesn't depend on the run it was written by
+    std::pmr::string blob(allocator);
+    blob.reserve(data.getValueSize());
+    blob.append(data.blob);
+    const auto materialize = [&data, &blob](Span span) {
+        if (!span.isInterned()) {
+            return span;
+        }
+
+        const Span copy{static_cast<std::uint32_t>(blob.size()), span.length};
+        blob.append(data.view(span));
+        return copy;
+    };
+
+    header.outputfile = data.outputfile;
+    header.application = materialize(data.application.value_or(Span{}));
+    std::pmr::vector<Span> spans(allocator);
+    spans.reserve(data.commands.size() + 2 * data.environmentKeys.size() +
+                  data.pathValues.size());
+
+    for (const auto *category : {
+                &data.commands, &data.environmentKeys, &data.environmentValues,
+                &data.pathValues
+            }) {
+        for (const Span span : *category) {
+            spans.push_back(materialize(span));
+        }
+    }
+
+    if (blob.size() > Span::INTERNED) {
+        throw std::length_error("Snapshot exceeds 2 GiB");
+    }
+
+    header.blobSize = static_cast<std::uint32_t>(blob.size());
+    std::pmr::string snapshot(allocator);
+    snapshot.reserve(sizeof(Header) + spans.size() * sizeof(Span) +
+                     blob.size());
+    snapshot.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    snapshot.append(reinterpret_cast<const char *>(spans.data()),
+                    spans.size() * sizeof(Span));
+    snapshot.append(blob);
+    return snapshot;
+}
+
+std::shared_ptr<FileData> Snapshot::load(const std::string &filename,
+        std::string_view content,
+        std::pmr::memory_resource *resource) {
+    LOG_INFO << "Loading snapshot " << filename;
+
+    if (content.size() < sizeof(Header) || !isSnapshot(content)) {
+        throw exceptions::InvalidSnapshotException(filename, "Missing header");
+    }
+
+    // Copied, as the content doesn't have to be aligned
+    Header header{};
+    std::memcpy(&header, content.data(), sizeof(Header));
+
+    // The values are stored in the byte order of the writing machine
+    if (header.version == swapBytes(VERSION)) {
+        throw exceptions::InvalidSnapshotException(
+            filename, "Written on a machine with another byte order");
+    }
+
+    if (header.version != VERSION) {
+        throw exceptions::InvalidSnapshotException(
+            filename, "Unsupported version " + std::to_string(header.version));
+    }
+
+    const std::uint64_t spanCount = std::uint64_t{header.commandCount} +
+                                    2 * std::uint64_t{header.environmentCount} + header.pathCount;
+
+    if (sizeof(Header) + spanCount * sizeof(Span) + header.blobSize !=
+            content.size()) {
+        throw exceptions::InvalidSnapshotException(filename,
+                "Size doesn't match the header");
+    }
+
+    auto data = std::allocate_shared<FileData>(
+                    std::pmr::polymorphic_allocator<FileData>(resource));
+    const char *position = content.data() + sizeof(Header);
+
+    const auto readSpans = [&](std::pmr::vector<Span> &spans,
+    std::uint32_t count) {
+        spans.resize(count);
+        std::memcpy(spans.data(), position, count * sizeof(Span));
+        position += count * sizeof(Span);
+    };
+
+    readSpans(data->commands, header.commandCount);
+    readSpans(data->environmentKeys, header.environmentCount);
+    readSpans(data->environmentValues, header.environmentCount);
+    readSpans(data->pathValues, header.pathCount);
+    data->blob.assign(position, header.blobSize);
+
+    // Every span has to be within the blob
+    const auto isValid = [&header](Span span) {
+        return !span.isInterned() &&
+               std::uint64_t{span.offset} + span.length <= header.blobSize;
+    };
+    bool valid = isValid(header.outputfile) && isValid(header.application);
+
+    for (const auto *spans : {
+                &data->commands, &data->environmentKeys, &data->environmentValues,
+                &data->pathValues
+            }) {
+        for (const Span span : *spans) {
+            valid = valid && isValid(span);
+        }
+    }
+
+    if (!valid) {
+        throw exceptions::InvalidSnapshotException(filename,
+                "Value outside of the blob");
+    }
+
+    data->outputfile = header.outputfile;
+    data->hideShell = (header.flags & HIDE_SHELL) != 0;
+
+    if ((header.flags & HAS_APPLICATION) != 0) {
+        data->application = header.application;
+    }
+
+    // The same checks as for json files, done once for all values
+    if (!data->getOutputFile().ends_with(".bat")) {
+        throw exceptions::InvalidSnapshotException(filename,
+                "Invalid outputfile");
+    }
+
+    if (JsonHandler::containsBadCharacter(data->blob)) {
+        throw exceptions::InvalidSnapshotException(filename,
+                "Contains bad characters");
+    }
+
+    return data;
+}
+} // namespace parsing
@@ -0,0 +1,169 @@
+/**
+ * @file TarWriter.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-18
+ * @version 0.3.0
+ * @brief Implementation of the TarWriter class.
+ *
+ * @see src/include/TarWriter.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "TarWriter.hpp"
+#include "Exceptions.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+namespace utilities {
+namespace {
+// Offsets and sizes of the fields of a ustar header
+constexpr std::size_t NAME = 0;
+constexpr std::size_t NAME_SIZE = 100;
+constexpr std::size_t MODE = 100;
+constexpr std::size_t UID = 108;
+constexpr std::size_t GID = 116;
+constexpr std::size_t SIZE = 124;
+constexpr std::size_t MTIME = 136;
+constexpr std::size_t CHECKSUM = 148;
+constexpr std::size_t TYPE = 156;
+constexpr std::size_t MAGIC = 257;
+constexpr std::size_t PREFIX = 345;
+constexpr std::size_t PREFIX_SIZE = 155;
+} // namespace
+
+TarWriter::TarWriter(std::string filename)
+    : filename(std::move(filename)), buffer(new char[BUFFER_SIZE]),
+      modificationTime(readModificationTime()) {
+    LOG_INFO << "Creating archive " << this->filename;
+    // The buffer has to be set before the file is opened
+    this->file.rdbuf()->pubsetbuf(this->buffer.get(), BUFFER_SIZE);
+    this->file.open(this->filename, std::ios::binary | std::ios::trunc);
+
+    if (!this->file.good()) {
+        throw exceptions::FailedToOpenFileException(this->filename);
+    }
+}
+
+void TarWriter::add(std::string_view name, std::string_view content) {
+    LOG_INFO << "Archiving " << name;
+    std::array<char, BLOCK_SIZE> header{};
+    const std::string path(name);
+
+    while (name.starts_with('/')) {
+        name.remove_prefix(1);
+    }
+
+    std::string_view prefix;
+
+    // Long names are split at a '/', so that both parts fit
+    if (name.size() > NAME_SIZE) {
+        const std::size_t split = name.rfind('/', PREFIX_SIZE);
+
+        if (split == std::string_view::npos || name.size() - split - 1 > NAME_SIZE ||
+                split + 1 == name.size()) {
+            throw exceptions::ArchiveException(path, "The path is too long");
+        }
+
+        prefix = name.substr(0, split);
+        name.remove_prefix(split + 1);
+    }
+
+    if (name.empty()) {
+        throw exceptions::ArchiveException(path, "The path is empty");
+    }
+
+    std::memcpy(header.data() + NAME, name.data(), name.size());
+    std::memcpy(header.data() + PREFIX, prefix.data(), prefix.size());
+
+    if (!writeOctal(header.data() + SIZE, 12, content.size())) {
+        throw exceptions::ArchiveException(path, "The file is too large");
+    }
+
+    writeOctal(header.data() + MODE, 8, 0644);
+    writeOctal(header.data() + UID, 8, 0);
+    writeOctal(header.data() + GID, 8, 0);
+    // Too large times are replaced, as they are only used for extracting
+    if (!writeOctal(header.data() + MTIME, 12, this->modificationTime)) {
+        writeOctal(header.data() + MTIME, 12, 0);
+    }
+
+    header[TYPE] = '0';
+    std::memcpy(header.data() + MAGIC, "ustar\0" "00", 8);
+
+    // The checksum is calculated with spaces in place of itself
+    std::memset(header.data() + CHECKSUM, ' ', 8);
+    const unsigned checksum = std::accumulate(header.begin(), header.end(), 0U,
+    [](unsigned sum, char c) {
+        return sum + static_cast<unsigned char>(c);
+    });
+    writeOctal(header.data() + CHECKSUM, 7, checksum);
+
+    // The content is padded to full blocks
+    static constexpr std::array<char, BLOCK_SIZE> padding{};
+    this->file.write(header.data(), BLOCK_SIZE);
+    this->file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    this->file.write(padding.data(), static_cast<std::streamsize>(
+                         (BLOCK_SIZE - content.size() % BLOCK_SIZE) % BLOCK_SIZE));
+
+    if (!this->file.good()) {
+        throw exceptions::ArchiveException(this->filename, "Failed to write");
+    }
+}
+
+void TarWriter::finish() {
+    LOG_INFO << "Finishing archive " << this->filename;
+    // Two empty blocks mark the end of the archive
+    static constexpr std::array<char, 2 * BLOCK_SIZE> end{};
+    this->file.write(end.data(), end.size());
+    this->file.close();
+
+    if (!this->file.good()) {
+        throw exceptions::ArchiveException(this->filename, "Failed to write");
+    }
+}
+
+bool TarWriter::writeOctal(char *field, std::size_t size,
+                           std::uint64_t value) {
+    // The last character of the field stays NUL
+    std::memset(field, '0', size - 1);
+    std::array<char, 24> digits{};
+    const auto result = std::to_chars(digits.data(), digits.data() + digits.size(),
+                                      value, 8);
+    const auto length = static_cast<std::size_t>(result.ptr - digits.data());
+
+    if (length > size - 1) {
+        return false;
+    }
+
+    std::memcpy(field + size - 1 - length, digits.data(), length);
+    return true;
+}
+
+std::uint64_t TarWriter::readModificationTime() {
+    // See https://reproducible-builds.org/specs/source-date-epoch/
+    const char *epoch = std::getenv("SOURCE_DATE_EPOCH");
+
+    if (epoch == nullptr) {
+        return 0;
+    }
+
+    const std::string_view value = epoch;
+    std::uint64_t time = 0;
+    const auto [end, error] = std::from_chars(value.data(),
+                              value.data() + value.size(), time);
+
+    if (error != std::errc() || end != value.data() + value.size()) {
+        LOG_WARNING << "Ignoring invalid SOURCE_DATE_EPOCH: " << value;
+        return 0;
+    }
+
+    return time;
+}
+} // namespace utilities
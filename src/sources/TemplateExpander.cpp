@@ -0,0 +1,197 @@
+/**
+ * @file TemplateExpander.cpp
+ * @author Elena Schwarzbach, Max Rodler, Simon Blum, Sonia Sinaci
+ * @date 2024-05-25
+ * @version 0.3.0
+ * @brief Implementation of the TemplateExpander class.
+ *
+ * @see src/include/TemplateExpander.hpp
+ *
+ * @copyright See LICENSE file
+ */
+
+#include "TemplateExpander.hpp"
+#include "Exceptions.hpp"
+#include "LoggingWrapper.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+#include <utility>
+
+namespace parsing {
+TemplateExpander &TemplateExpander::getInstance() {
+    static TemplateExpander templateExpander;
+    return templateExpander;
+}
+
+void TemplateExpander::define(std::string_view definition,
+                              const std::string &source) {
+    const std::size_t separator = definition.find('=');
+
+    if (separator == std::string_view::npos ||
+            !isName(definition.substr(0, separator))) {
+        throw exceptions::InvalidValueException(
+            source, "\"" + std::string(definition) +
+            "\" isn't a definition like NAME=VALUE!");
+    }
+
+    LOG_INFO << "Defining " << definition.substr(0, separator);
+    this->defines.insert_or_assign(std::string(definition.substr(0, separator)),
+                                   std::string(definition.substr(separator + 1)));
+}
+
+void TemplateExpander::loadDefines(const std::string &path) {
+    LOG_INFO << "Loading defines from " << path;
+    std::ifstream file(path);
+
+    if (!file) {
+        throw exceptions::FailedToOpenFileException(path);
+    }
+
+    std::string line;
+
+    while (std::getline(file, line)) {
+        if (line.ends_with('\r')) {
+            line.pop_back();
+        }
+
+        if (line.empty() || line.starts_with('#')) {
+            continue;
+        }
+
+        this->define(line, path);
+    }
+}
+
+void TemplateExpander::resolve() {
+    std::vector<std::string_view> resolving;
+
+    for (const auto &define : this->defines) {
+        (void)this->resolveDefine(define.first, resolving);
+    }
+
+    LOG_INFO << "Resolved " << this->resolved.size() << " defines";
+}
+
+std::string_view TemplateExpander::expand(std::string_view key,
+        std::string_view value) {
+    // Most values don't contain a placeholder, they are never copied
+    if (value.find("${") == std::string_view::npos) {
+        return value;
+    }
+
+    {
+        const std::shared_lock lock(this->memoMutex);
+
+        if (const auto expanded = this->memo.find(value);
+                expanded != this->memo.end()) {
+            ++this->reused;
+            return expanded->second;
+        }
+    }
+
+    // Another thread may expand the same value, both results are equal
+    std::string expanded = substitute(value, [this, key](std::string_view name)
+    -> const std::string & {
+        const auto define = this->resolved.find(name);
+
+        if (define == this->resolved.end()) {
+            throw exceptions::InvalidValueException(
+                std::string(key), "\"${" + std::string(name) + "}\" isn't defined!");
+        }
+
+        return define->second;
+    });
+
+    const std::unique_lock lock(this->memoMutex);
+    return this->memo.emplace(std::string(value),
+                              std::move(expanded)).first->second;
+}
+
+TemplateExpander::Statistics TemplateExpander::getStatistics() const {
+    const std::shared_lock lock(this->memoMutex);
+    return {this->memo.size(), this->reused};
+}
+
+bool TemplateExpander::isName(std::string_view name) {
+    const auto isNameCharacter = [](unsigned char c) {
+        return std::isalnum(c) || c == '_';
+    };
+
+    return !name.empty() &&
+           !std::isdigit(static_cast<unsigned char>(name.front())) &&
+           std::ranges::all_of(name, isNameCharacter);
+}
+
+std::string TemplateExpander::substitute(std::string_view value,
+        const Lookup &lookup) {
+    std::string expanded;
+    expanded.reserve(value.size());
+
+    for (std::size_t dollar = value.find('$'); dollar != std::string_view::npos;
+            dollar = value.find('$')) {
+        expanded += value.substr(0, dollar);
+        value.remove_prefix(dollar);
+
+        if (value.starts_with("$${")) {
+            expanded += "${";
+            value.remove_prefix(3);
+            continue;
+        }
+
+        // Anything but a valid name is kept as it is
+        if (const std::size_t close = value.find('}');
+                value.starts_with("${") && close != std::string_view::npos &&
+                isName(value.substr(2, close - 2))) {
+            expanded += lookup(value.substr(2, close - 2));
+            value.remove_prefix(close + 1);
+            continue;
+        }
+
+        expanded += '$';
+        value.remove_prefix(1);
+    }
+
+    expanded += value;
+    return expanded;
+}
+
+const std::string &TemplateExpander::resolveDefine(std::string_view name,
+        std::vector<std::string_view> &resolving) {
+    if (const auto done = this->resolved.find(name);
+            done != this->resolved.end()) {
+        return done->second;
+    }
+
+    const auto define = this->defines.find(name);
+
+    // resolve() only passes defined names, so another define refers to it
+    if (define == this->defines.end()) {
+        throw exceptions::InvalidValueException(
+            std::string(resolving.back()),
+            "\"${" + std::string(name) + "}\" isn't defined!");
+    }
+
+    if (std::ranges::find(resolving, name) != resolving.end()) {
+        std::string cycle;
+
+        for (const auto &resolvingName : resolving) {
+            cycle += std::string(resolvingName) + " -> ";
+        }
+
+        throw exceptions::InvalidValueException(
+            std::string(name), "The define refers to itself: " + cycle +
+            std::string(name));
+    }
+
+    resolving.push_back(define->first);
+    std::string value = substitute(define->second, [this, &resolving](
+    std::string_view next) -> const std::string & {
+        return this->resolveDefine(next, resolving);
+    });
+    resolving.pop_back();
+    return this->resolved.emplace(define->first, std::move(value)).first->second;
+}
+} // namespace parsing
@@ -36,6 +36,13 @@ bool Utils::askToContinue(const std::string &prompt) {
     LOG_INFO << "Asking for user Confirmation to continue...";
     OUTPUT << cli::BOLD << prompt << cli::RESET;
 
+    // The standard input contains the configurations
+    if (!interactive) {
+        LOG_INFO << "Not interactive, continuing";
+        OUTPUT << "y\n";
+        return true;
+    }
+
     do {
         std::cin >> userInput;
         std::ranges::transform(userInput, userInput.begin(), ::tolower);
@@ -75,13 +82,12 @@ const std::string &Utils::checkDirectory(std::string &directory) {
     return directory;
 }
 bool Utils::handleParseException(const std::exception &e,
-                                 const std::vector<std::string>::iterator &file,
-                                 const std::vector<std::string> &files) {
-    OUTPUT << "\nThere has been a error while trying to parse \"" << *file
+                                 const std::string &name, bool hasMore) {
+    OUTPUT << "\nThere has been a error while trying to parse \"" << name
            << ":\n";
     LOG_ERROR << e.what();
 
-    if (std::next(file) != files.end() &&
+    if (hasMore &&
             !utilities::Utils::askToContinue(
                 "Do you want to continue with the other files? (y/n) "
                 "")) {
@@ -90,11 +96,11 @@ bool Utils::handleParseException(const std::exception &e,
         return false;
     }
 
-    std::cout << std::endl;
+    logging::consoleOutput() << std::endl;
     return true;
 }
 
-std::string Utils::escapeString(const std::string &str) {
+std::string Utils::escapeString(std::string_view str) {
     // Map of characters to their escape sequences
     static const std::unordered_map<char, std::string> escapeSequences = {
         {'\\', "\\\\"},    // Replace backslash with double backslash